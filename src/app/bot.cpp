@@ -0,0 +1,125 @@
+#include "bot.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <functional>
+#include <queue>
+#include <stdexcept>
+#include <utility>
+
+#include "simulation.h"
+#include "threadpool.h"
+
+const Direction CLOCKWISE[DIRECTION_SIZE] = {UP, RIGHT, DOWN, LEFT};  // для поворотов WallFollowerStrategy
+
+RandomWalkStrategy::RandomWalkStrategy(unsigned seed) : random_(seed) {}
+
+char RandomWalkStrategy::nextMove(const GameField&, Position) {
+    return MOVE_DIRECTIONS[random_() % DIRECTION_SIZE].key;
+}
+
+WallFollowerStrategy::WallFollowerStrategy() : heading_(1) {}
+
+char WallFollowerStrategy::nextMove(const GameField& gameField, Position position) {
+    // пробуем направо, прямо, налево и только потом назад
+    for (const int turn : {1, 0, 3, 2}) {
+        const int            heading   = (heading_ + turn) % DIRECTION_SIZE;
+        const MoveDirection& direction = MOVE_DIRECTIONS[CLOCKWISE[heading]];
+        if (gameField.canMove({position.x + direction.offset.x, position.y + direction.offset.y})) {
+            heading_ = heading;
+            return direction.key;
+        }
+    }
+    return MOVE_DIRECTIONS[CLOCKWISE[heading_]].key;  // замурован: ход в стену
+}
+
+AStarStrategy::AStarStrategy() : from_{-1, -1} {}
+
+void AStarStrategy::plan(const GameField& gameField, Position position) {
+    auto getIndex     = [](Position cell) { return cell.x * COLUMNS + cell.y; };
+    auto getHeuristic = [](Position cell) { return std::abs(cell.x - GAME_END.x) + std::abs(cell.y - GAME_END.y); };
+
+    std::vector<int> costs(ROWS * COLUMNS, -1), parents(ROWS * COLUMNS, -1);  // parents - индекс хода в клетку
+    std::priority_queue<std::pair<int, int>, std::vector<std::pair<int, int>>, std::greater<std::pair<int, int>>>
+        open;  // (оценка пути, клетка)
+
+    costs[getIndex(position)] = 0;
+    open.push({getHeuristic(position), getIndex(position)});
+    while (!open.empty()) {
+        const auto [estimate, index] = open.top();
+        open.pop();
+
+        const Position current = {index / COLUMNS, index % COLUMNS};
+        if (current == GAME_END) break;
+        if (estimate != costs[index] + getHeuristic(current)) continue;  // устаревшая запись
+
+        for (int i = 0; i != DIRECTION_SIZE; ++i) {
+            const Position next = {current.x + MOVE_DIRECTIONS[i].offset.x, current.y + MOVE_DIRECTIONS[i].offset.y};
+            if (!gameField.canMove(next)) continue;
+
+            const int nextIndex = getIndex(next);
+            if (costs[nextIndex] != -1 && costs[nextIndex] <= costs[index] + 1) continue;
+            costs[nextIndex]   = costs[index] + 1;
+            parents[nextIndex] = i;
+            open.push({costs[nextIndex] + getHeuristic(next), nextIndex});
+        }
+    }
+
+    // путь восстанавливается от финиша, поэтому уже лежит в обратном порядке
+    path_.clear();
+    from_ = position;
+    if (costs[getIndex(GAME_END)] == -1) return;
+    for (Position current = GAME_END; !(current == position);) {
+        const MoveDirection& direction = MOVE_DIRECTIONS[parents[getIndex(current)]];
+        path_.push_back(direction.key);
+        current = {current.x - direction.offset.x, current.y - direction.offset.y};
+    }
+}
+
+char AStarStrategy::nextMove(const GameField& gameField, Position position) {
+    if (path_.empty() || !(position == from_)) plan(gameField, position);
+    if (path_.empty()) return MOVE_DIRECTIONS[UP].key;  // финиш недостижим
+
+    const MoveDirection* direction = findMoveDirection(path_.back());
+    path_.pop_back();
+    from_ = {position.x + direction->offset.x, position.y + direction->offset.y};
+    return direction->key;
+}
+
+std::unique_ptr<BotStrategy> makeBotStrategy(const std::string& name, unsigned seed) {
+    if (name == "random") return std::make_unique<RandomWalkStrategy>(seed);
+    if (name == "wall") return std::make_unique<WallFollowerStrategy>();
+    if (name == "astar") return std::make_unique<AStarStrategy>();
+    throw std::invalid_argument("Invalid bot strategy: " + name);
+}
+
+BotReport runBots(LogComponent* logComponent, const std::string& strategy, size_t botCount, size_t threadCount,
+                  size_t maxMoves, unsigned firstSeed) {
+    makeBotStrategy(strategy, 0);  // неизвестная стратегия - исключение до запуска потоков
+
+    std::atomic<size_t> finishedCount(0), moveCount(0), failedMoves(0);
+    const auto          begin = std::chrono::steady_clock::now();
+    {
+        ThreadPool pool(threadCount);
+        for (size_t i = 0; i != botCount; ++i) {
+            pool.submit([&, seed = firstSeed + static_cast<unsigned>(i)]() {
+                // события не копятся в движке: бот пишет только в журнал
+                SimulationEngine             engine(logComponent, false);
+                std::unique_ptr<BotStrategy> bot = makeBotStrategy(strategy, seed);
+                SimulationResult             result{GAME_BEGIN, 0, 0, 0, false};
+
+                engine.generate(seed);
+                while (!result.isFinished && result.moveCount != maxMoves)
+                    engine.step(bot->nextMove(engine.getGameField(), engine.getPosition()), result);
+
+                if (result.isFinished) finishedCount.fetch_add(1);
+                moveCount.fetch_add(result.moveCount);
+                failedMoves.fetch_add(result.failedMoves);
+            });
+        }
+        pool.shutdown();
+    }
+
+    return {botCount, finishedCount.load(), moveCount.load(), failedMoves.load(),
+            std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - begin)};
+}
\ No newline at end of file
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <logger/logger.h>
+
+#include <chrono>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "game.h"
+#include "position.h"
+
+// боты проходят лабиринты через SimulationEngine::step и пишут в журнал то же, что Player::processMove,
+// поэтому сотни ботов на пуле потоков дают нагрузку на журнал, похожую на настоящие игры
+
+class BotStrategy {  // как бот выбирает следующий ход
+   public:
+    virtual ~BotStrategy() = default;
+
+    virtual char nextMove(const GameField& gameField, Position position) = 0;  // клавиша движения
+};
+
+class RandomWalkStrategy : public BotStrategy {  // случайная клавиша, в том числе в стену
+   private:
+    std::mt19937 random_;
+
+   public:
+    explicit RandomWalkStrategy(unsigned seed);
+
+    char nextMove(const GameField& gameField, Position position) override;
+};
+
+class WallFollowerStrategy : public BotStrategy {  // правило правой руки
+   private:
+    int heading_;  // куда смотрит бот, по часовой стрелке: 0 - вверх, 1 - вправо, 2 - вниз, 3 - влево
+
+   public:
+    WallFollowerStrategy();
+
+    char nextMove(const GameField& gameField, Position position) override;
+};
+
+class AStarStrategy : public BotStrategy {  // кратчайший путь A* с манхэттенской эвристикой
+   private:
+    std::vector<char> path_;  // оставшиеся ходы в обратном порядке
+    Position          from_;  // откуда должен идти следующий ход пути
+
+    void plan(const GameField& gameField, Position position);  // поиск пути до финиша
+
+   public:
+    AStarStrategy();
+
+    char nextMove(const GameField& gameField, Position position) override;
+};
+
+std::unique_ptr<BotStrategy> makeBotStrategy(const std::string& name, unsigned seed);  // random, wall, astar
+
+struct BotReport {  // итог прогона ботов
+    size_t                   botCount;       // сколько ботов сыграло
+    size_t                   finishedCount;  // сколько дошло до финиша
+    size_t                   moveCount;      // ходов всего
+    size_t                   failedMoves;    // упоров в стену или блок
+    std::chrono::nanoseconds elapsed;        // от первого хода до конца последней игры
+};
+
+BotReport runBots(LogComponent* logComponent, const std::string& strategy, size_t botCount, size_t threadCount,
+                  size_t maxMoves = 10000, unsigned firstSeed = 1);  // бот i играет лабиринт firstSeed + i
\ No newline at end of file
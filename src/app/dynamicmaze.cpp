@@ -0,0 +1,215 @@
+#include "dynamicmaze.h"
+
+#include <algorithm>
+#include <queue>
+#include <utility>
+
+constexpr size_t MAX_NODES_PER_CELL = 4;  // лес разросся сильнее - метки строятся заново
+
+DynamicMaze::DynamicMaze(GameField& gameField, unsigned seed)
+    : gameField_(gameField),
+      rows_(gameField.getRows()),
+      columns_(gameField.getColumns()),
+      labels_(static_cast<size_t>(rows_ * columns_), -1),
+      visitStamps_(static_cast<size_t>(rows_ * columns_), 0),
+      visitOwners_(static_cast<size_t>(rows_ * columns_), 0),
+      stamp_(0),
+      random_(seed),
+      mutationCount_(0),
+      rejectedCount_(0) {
+    rebuildLabels();
+}
+
+int DynamicMaze::makeNode() {
+    parents_.push_back(static_cast<int>(parents_.size()));
+    return parents_.back();
+}
+
+int DynamicMaze::findRoot(int node) {
+    while (parents_[node] != node) {
+        parents_[node] = parents_[parents_[node]];  // половинное сокращение пути
+        node           = parents_[node];
+    }
+    return node;
+}
+
+void DynamicMaze::unite(int first, int second) {
+    first  = findRoot(first);
+    second = findRoot(second);
+    if (first != second) parents_[second] = first;
+}
+
+int DynamicMaze::getNeighbours(int cell, int* neighbours) const {
+    const Position current = {cell / columns_, cell % columns_};
+    int            count   = 0;
+    for (const auto& direction : MOVE_DIRECTIONS) {
+        const Position next = {current.x + direction.offset.x, current.y + direction.offset.y};
+        if (next.x < 0 || next.x >= rows_ || next.y < 0 || next.y >= columns_) continue;
+
+        const int nextCell = next.x * columns_ + next.y;
+        if (labels_[nextCell] != -1) neighbours[count++] = nextCell;
+    }
+    return count;
+}
+
+void DynamicMaze::rebuildLabels() {
+    // каждая компонента - один узел, все клетки компоненты указывают прямо на него
+    parents_.clear();
+    for (int cell = 0; cell != rows_ * columns_; ++cell)
+        labels_[cell] = gameField_.isPassable({cell / columns_, cell % columns_}) ? -2 : -1;  // -2 - еще не размечена
+
+    std::queue<int> queue;
+    int             neighbours[DIRECTION_SIZE];
+    for (int cell = 0; cell != rows_ * columns_; ++cell) {
+        if (labels_[cell] != -2) continue;
+
+        const int node = makeNode();
+        labels_[cell]  = node;
+        for (queue.push(cell); !queue.empty(); queue.pop()) {
+            const int count = getNeighbours(queue.front(), neighbours);
+            for (int i = 0; i != count; ++i) {
+                if (labels_[neighbours[i]] != -2) continue;
+                labels_[neighbours[i]] = node;
+                queue.push(neighbours[i]);
+            }
+        }
+    }
+}
+
+void DynamicMaze::openLabel(int cell) {
+    int       neighbours[DIRECTION_SIZE];
+    const int count = getNeighbours(cell, neighbours);
+
+    labels_[cell] = makeNode();
+    for (int i = 0; i != count; ++i) unite(labels_[cell], labels_[neighbours[i]]);
+}
+
+void DynamicMaze::closeLabel(int cell) {
+    // поиски от каждого соседа идут по очереди по одной клетке. встретившиеся поиски сливаются,
+    // исчерпавший свою часть - это отколовшаяся компонента, ей заводится новый узел.
+    // последний оставшийся поиск - самая большая часть, она сохраняет старый узел и не обходится целиком
+    struct Search {
+        std::queue<int>  queue;    // граница поиска
+        std::vector<int> visited;  // пройденные клетки, для новых меток
+        int              owner;    // в какой поиск слит, сам себе - еще самостоятельный
+        bool             isActive;
+    };
+
+    labels_[cell] = -1;
+
+    int       neighbours[DIRECTION_SIZE];
+    const int count = getNeighbours(cell, neighbours);
+    if (count <= 1) return;  // тупик или одиночная клетка: ничего не откалывается
+
+    if (++stamp_ == 0) {  // счетчик меток прошел полный круг
+        std::fill(visitStamps_.begin(), visitStamps_.end(), 0);
+        stamp_ = 1;
+    }
+
+    Search searches[DIRECTION_SIZE];
+    for (int i = 0; i != count; ++i) {
+        visitStamps_[neighbours[i]] = stamp_;
+        visitOwners_[neighbours[i]] = static_cast<uint8_t>(i);
+        searches[i].queue.push(neighbours[i]);
+        searches[i].visited.push_back(neighbours[i]);
+        searches[i].owner    = i;
+        searches[i].isActive = true;
+    }
+
+    auto getOwner = [&searches](int search) {
+        while (searches[search].owner != search) search = searches[search].owner;
+        return search;
+    };
+
+    int activeCount = count, nextNeighbours[DIRECTION_SIZE];
+    while (activeCount > 1) {
+        for (int i = 0; i != count && activeCount > 1; ++i) {
+            Search& search = searches[i];
+            if (!search.isActive) continue;
+
+            if (search.queue.empty()) {
+                const int node = makeNode();
+                for (const int visited : search.visited) labels_[visited] = node;
+                search.isActive = false;
+                --activeCount;
+                continue;
+            }
+
+            const int current = search.queue.front();
+            search.queue.pop();
+
+            const int nextCount = getNeighbours(current, nextNeighbours);
+            for (int j = 0; j != nextCount; ++j) {
+                const int next = nextNeighbours[j];
+                if (visitStamps_[next] != stamp_) {
+                    visitStamps_[next] = stamp_;
+                    visitOwners_[next] = static_cast<uint8_t>(i);
+                    search.queue.push(next);
+                    search.visited.push_back(next);
+                    continue;
+                }
+
+                // встреча с другим поиском: забираем его границу и пройденное
+                const int other = getOwner(visitOwners_[next]);
+                if (other == i) continue;
+
+                Search& merged = searches[other];
+                for (; !merged.queue.empty(); merged.queue.pop()) search.queue.push(merged.queue.front());
+                search.visited.insert(search.visited.end(), merged.visited.begin(), merged.visited.end());
+                merged.visited.clear();
+                merged.owner    = i;
+                merged.isActive = false;
+                --activeCount;
+            }
+        }
+    }
+}
+
+bool DynamicMaze::isConnected(Position first, Position second) {
+    const int firstLabel = labels_[first.x * columns_ + first.y], secondLabel = labels_[second.x * columns_ + second.y];
+    return firstLabel != -1 && secondLabel != -1 && findRoot(firstLabel) == findRoot(secondLabel);
+}
+
+bool DynamicMaze::tryBlock(Position position, Position player) {
+    // метки меняются заранее; если игрок отрезан от финиша, клетка открывается обратно
+    if (position.x <= 0 || position.x >= rows_ - 1 || position.y <= 0 || position.y >= columns_ - 1) return false;
+    if (position == player || !gameField_.isPassable(position)) return false;
+
+    const int cell = position.x * columns_ + position.y;
+    closeLabel(cell);
+    if (!isConnected(player, gameField_.getFinish())) {
+        openLabel(cell);
+        ++rejectedCount_;
+        return false;
+    }
+
+    gameField_.setBlock(position, true);
+    ++mutationCount_;
+    if (parents_.size() > MAX_NODES_PER_CELL * labels_.size()) rebuildLabels();
+    return true;
+}
+
+void DynamicMaze::unblock(Position position) {
+    if (position.x <= 0 || position.x >= rows_ - 1 || position.y <= 0 || position.y >= columns_ - 1) return;
+    if (gameField_.isPassable(position)) return;
+
+    gameField_.setBlock(position, false);
+    openLabel(position.x * columns_ + position.y);
+    ++mutationCount_;
+    if (parents_.size() > MAX_NODES_PER_CELL * labels_.size()) rebuildLabels();
+}
+
+bool DynamicMaze::mutate(Position player) {
+    // случайная внутренняя клетка: блок исчезает, пустая клетка становится блоком, если это безопасно
+    const Position position = {1 + static_cast<int>(random_() % static_cast<unsigned>(rows_ - 2)),
+                               1 + static_cast<int>(random_() % static_cast<unsigned>(columns_ - 2))};
+    if (!gameField_.isPassable(position)) {
+        unblock(position);
+        return true;
+    }
+    return tryBlock(position, player);
+}
+
+size_t DynamicMaze::getMutationCount() const { return mutationCount_; }
+
+size_t DynamicMaze::getRejectedCount() const { return rejectedCount_; }
\ No newline at end of file
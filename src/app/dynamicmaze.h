@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "game.h"
+#include "position.h"
+
+// лабиринт, который меняется во время игры: блоки появляются и исчезают, но путь от игрока до финиша
+// остается всегда. связность хранится метками компонент в системе непересекающихся множеств:
+// открытие клетки - объединение с соседями, закрытие - поиск от соседей в очередь по шагу каждому,
+// который останавливается, как только все встретились или один из них исчерпал свою часть.
+// работа пропорциональна меньшей из отколовшихся частей, а не всему полю
+
+class DynamicMaze {  // изменения поля с сохранением пути до финиша
+   private:
+    GameField&            gameField_;      // поле, которое меняем
+    int                   rows_;           // число строк поля
+    int                   columns_;        // число столбцов поля
+    std::vector<int>      labels_;         // клетка -> узел множеств, -1 - непроходима
+    std::vector<int>      parents_;        // лес узлов, корень - сам себе родитель
+    std::vector<uint32_t> visitStamps_;    // метка поиска, в котором клетка уже пройдена
+    std::vector<uint8_t>  visitOwners_;    // какой из поисков (от какого соседа) ее прошел
+    uint32_t              stamp_;          // номер текущего поиска
+    std::mt19937          random_;         // выбор клеток для mutate
+    size_t                mutationCount_;  // сколько изменений сделано
+    size_t                rejectedCount_;  // сколько закрытий отклонено: отрезали бы игрока от финиша
+
+    int  makeNode();                                      // новый узел-корень
+    int  findRoot(int node);                              // корень с сокращением путей
+    void unite(int first, int second);                    // объединить множества узлов
+    void rebuildLabels();                                 // метки заново обходом всего поля
+    void openLabel(int cell);                             // клетка стала проходимой
+    void closeLabel(int cell);                            // стала непроходимой: отколовшимся частям новые узлы
+    int  getNeighbours(int cell, int* neighbours) const;  // проходимые соседи, возвращает их число
+
+   public:
+    explicit DynamicMaze(GameField& gameField, unsigned seed = 0);
+
+    bool isConnected(Position first, Position second);  // есть ли путь между клетками
+    bool tryBlock(Position position, Position player);  // поставить блок, если игрок не отрезан от финиша
+    void unblock(Position position);                    // убрать блок (связность только растет)
+    bool mutate(Position player);                       // случайное изменение, false - отклонено
+
+    size_t getMutationCount() const;  // сколько изменений сделано
+    size_t getRejectedCount() const;  // сколько закрытий отклонено
+};
\ No newline at end of file
@@ -1,176 +1,381 @@
 #include "game.h"
 
-#include "../app/manager.h"
-
-bool GameField::isPathExists(Position currentPos, std::queue<Position>& path, std::vector<std::vector<bool>>& visited) {
-    // используется стандартный обход в глубину через рекурсию
-    if (currentPos == GAME_END_) return true;
-
-    const Position directions[DIRECTION_SIZE] = {RIGHT_POS, UP_POS, LEFT_POS, DOWN_POS};
-
-    for (int i = 0; i != DIRECTION_SIZE; ++i) {
-        Position next = {currentPos.x + directions[i].x, currentPos.y + directions[i].y};
-
-        auto isInBound = [&]() -> bool { return next.x >= 0 && next.x < ROWS_ && next.y >= 0 && next.y < COLUMNS_; };
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
-        auto isFree = [&]() -> bool { return field_[next.x][next.y] == NOTHING; };
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
 
-        if (isInBound() && isFree() && !visited[next.x][next.y]) {
-            visited[next.x][next.y] = true;
-            path.push(next);
-
-            if (isPathExists(next, path, visited)) return true;
-
-            path.pop();
-            visited[currentPos.x][currentPos.y] = false;
-        }
-    }
+#include "../app/manager.h"
 
-    return false;
+void fillCells(char* cells, size_t size, char value) {
+    // заливка по 16 байт за запись, хвост - по одному
+    size_t i = 0;
+#if defined(__SSE2__)
+    const __m128i pattern = _mm_set1_epi8(value);
+    for (; i + 16 <= size; i += 16) _mm_storeu_si128(reinterpret_cast<__m128i*>(cells + i), pattern);
+#endif
+    for (; i != size; ++i) cells[i] = value;
 }
 
-void GameField::generateBlocks() {
+void GameField::generateBlocks(std::mt19937& random) {
     // случайным образом заполняем все поле блоками
     // далее начинаем раскопки - удаляем случайным образом какие-то позиции
-    //
-    srand(static_cast<unsigned>(time(nullptr)));
-    for (int i = 1; i != ROWS_ - 1; ++i) {
-        for (int j = 1; j != COLUMNS_ - 1; ++j) {
-            field_[i][j] = BLOCK;
-        }
-    }
+    // генератор свой у каждого поля, поэтому поля можно строить параллельно
+    for (int i = 1; i != ROWS_ - 1; ++i) fillCells(&field_[getIndex({i, 1})], COLUMNS_ - 2, BLOCK);
+
+    // рамка из стен - граница: у внутренних клеток все соседи есть в массиве, а стена не бывает
+    // ни блоком, ни пустотой, поэтому проверки выхода за поле не нужны. финиш лежит в рамке
+    // и пуст, на время раскопок закрываем его стеной, чтобы он не считался пустым соседом
+    const int finish = getIndex(GAME_END_);
+    field_[finish]   = WALL_VERTICAL;
 
-    auto isInBounds = [&](int x, int y) -> bool { return x > 0 && x < ROWS_ - 1 && y > 0 && y < COLUMNS_ - 1; };
+    const int offsets[DIRECTION_SIZE] = {-COLUMNS_, COLUMNS_, -1, 1};  // UP, DOWN, LEFT, RIGHT по индексу
 
-    std::vector<Position> walls;
-    int                   startX = 1 + rand() % (ROWS_ - 2);
-    int                   startY = 1 + rand() % (COLUMNS_ - 2);
-    field_[startX][startY]       = NOTHING;
+    std::vector<int> walls;
+    int              startX            = 1 + random() % (ROWS_ - 2);
+    int              startY            = 1 + random() % (COLUMNS_ - 2);
+    field_[getIndex({startX, startY})] = NOTHING;
 
     // соседи
-    auto addWalls = [&](int x, int y) -> void {
-        if (isInBounds(x - 1, y) && field_[x - 1][y] == BLOCK) walls.push_back({x - 1, y});
-        if (isInBounds(x + 1, y) && field_[x + 1][y] == BLOCK) walls.push_back({x + 1, y});
-        if (isInBounds(x, y - 1) && field_[x][y - 1] == BLOCK) walls.push_back({x, y - 1});
-        if (isInBounds(x, y + 1) && field_[x][y + 1] == BLOCK) walls.push_back({x, y + 1});
+    auto addWalls = [&](int cell) -> void {
+        for (const int offset : offsets) {
+            if (field_[cell + offset] == BLOCK) walls.push_back(cell + offset);
+        }
     };
 
-    addWalls(startX, startY);
+    addWalls(getIndex({startX, startY}));
 
     while (!walls.empty()) {
-        int      randomIndex = rand() % walls.size();
-        Position wall        = walls[randomIndex];
+        int randomIndex = random() % walls.size();
+        int wall        = walls[randomIndex];
         walls.erase(walls.begin() + randomIndex);
 
-        int x = wall.x;
-        int y = wall.y;
-
-        int adjCount = 0;
-
-        if (isInBounds(x - 1, y) && field_[x - 1][y] == NOTHING) ++adjCount;
-        if (isInBounds(x + 1, y) && field_[x + 1][y] == NOTHING) ++adjCount;
-        if (isInBounds(x, y - 1) && field_[x][y - 1] == NOTHING) ++adjCount;
-        if (isInBounds(x, y + 1) && field_[x][y + 1] == NOTHING) ++adjCount;
+        const int adjCount = (field_[wall - COLUMNS_] == NOTHING) + (field_[wall + COLUMNS_] == NOTHING) +
+                             (field_[wall - 1] == NOTHING) + (field_[wall + 1] == NOTHING);
 
         if (adjCount <= 1) {  // проверяем, что только один пустой сосед
-            field_[x][y] = NOTHING;
-            addWalls(x, y);
+            field_[wall] = NOTHING;
+            addWalls(wall);
         }
     }
 
     // дополнительная генерации - добавляем еще блоки
     for (int i = 0; i != 15;) {
-        int deadEndX = 1 + rand() % (ROWS_ - 2);
-        int deadEndY = 1 + rand() % (COLUMNS_ - 2);
+        int deadEndX = 1 + random() % (ROWS_ - 2);
+        int deadEndY = 1 + random() % (COLUMNS_ - 2);
 
-        if (field_[deadEndX][deadEndY] == NOTHING) {
+        if (field_[getIndex({deadEndX, deadEndY})] == NOTHING) {
             ++i;
-            int direction = rand() % DIRECTION_SIZE;
-            switch (direction) {
-                case UP:
-                    if (isInBounds(deadEndX - 1, deadEndY)) field_[deadEndX - 1][deadEndY] = BLOCK;
-                    break;
-                case DOWN:
-                    if (isInBounds(deadEndX + 1, deadEndY)) field_[deadEndX + 1][deadEndY] = BLOCK;
-                    break;
-                case LEFT:
-                    if (isInBounds(deadEndX, deadEndY - 1)) field_[deadEndX][deadEndY - 1] = BLOCK;
-                    break;
-                case RIGHT:
-                    if (isInBounds(deadEndX, deadEndY + 1)) field_[deadEndX][deadEndY + 1] = BLOCK;
-                    break;
-            }
+            // внутри поля сейчас только пустота и блоки, стены рамки не трогаем
+            char& cell = field_[getIndex({deadEndX, deadEndY}) + offsets[random() % DIRECTION_SIZE]];
+            cell       = cell == NOTHING ? BLOCK : cell;
         }
     }
 
-    if (isInBounds(GAME_BEGIN_.x, GAME_BEGIN_.y + 1)) field_[GAME_BEGIN_.x][GAME_BEGIN_.y + 1] = NOTHING;
-    if (isInBounds(GAME_END_.x, GAME_END_.y - 1)) field_[GAME_END_.x][GAME_END_.y - 1] = NOTHING;
+    field_[finish]                                       = NOTHING;
+    field_[getIndex({GAME_BEGIN_.x, GAME_BEGIN_.y + 1})] = NOTHING;
+    field_[getIndex({GAME_END_.x, GAME_END_.y - 1})]     = NOTHING;
+}
+
+Task<> GameField::calculateGameField(TaskScheduler& scheduler) {
+    // лабиринт тот же, что дал бы generate, но попытки чередуются с другими задачами:
+    // на одном рабочем потоке игра и журнал не стоят, пока ищется проходимый лабиринт
+    TraceSpan      span(getTracer(), "GameField::calculateGameField");
+    const unsigned seed = static_cast<unsigned>(time(nullptr));
+    std::mt19937   random(seed);
+    seed_ = seed;
+    buildBorders();
+
+    int countGen = 1;
+    while (!generateAttempt(random, countGen)) {
+        ++countGen;
+        co_await scheduler.yield();
+    }
+
+    app->writeEvent(*logComponent_, LogEvent("GameField::calculateGameField",
+                                             "{} attempts required for maze generation.",
+                                             {intField("attempts", countGen)}));
 }
 
-void GameField::calculateGameField() {
+int GameField::generate(unsigned seed) {
     // генерируем игровое поле стандартными значениями
     // далее пытаемся сгенерировать лабиринт на основе случайных чисел
     // проверяем, что хотя бы один путь существует
-    std::vector<std::vector<char>> field(ROWS_, std::vector<char>(COLUMNS_));
+    // одно и то же зерно дает один и тот же лабиринт
+    std::mt19937 random(seed);
+    seed_ = seed;
+    buildBorders();
+
+    int countGen = 1;
+    while (!generateAttempt(random, countGen)) ++countGen;
+
+    return countGen;
+}
+
+bool GameField::generateAttempt(std::mt19937& random, int attempt) {
+    // путь существует, если поиск в ширину от финиша дошел до старта.
+    // расстояния остаются и дальше служат подсказками
+    TraceSpan span(getTracer(), "GameField::generateAttempt", "attempt", attempt);
+    generateBlocks(random);
+    calculateDistances();
+
+    return getDistance(GAME_BEGIN_) != UNREACHABLE_DISTANCE;
+}
+
+void GameField::buildBorders() {
+    // стены по краям, внутри пусто, игрок на старте
+    field_.resize(static_cast<size_t>(ROWS_ * COLUMNS_));
     for (int i = 0; i != ROWS_; ++i) {
-        for (int j = 0; j != COLUMNS_; ++j) {
-            if (i == 0 || i == ROWS_ - 1) {
-                if (j == 0 || j == COLUMNS_ - 1)
-                    field[i][j] = WALL_CORNER;
-                else
-                    field[i][j] = WALL_HORIZONTAL;
-            } else {
-                if (j == 0 || j == COLUMNS_ - 1)
-                    field[i][j] = WALL_VERTICAL;
-                else
-                    field[i][j] = NOTHING;
-            }
+        char* row = &field_[getIndex({i, 0})];
+        if (i == 0 || i == ROWS_ - 1) {
+            fillCells(row, COLUMNS_, WALL_HORIZONTAL);
+            row[0] = row[COLUMNS_ - 1] = WALL_CORNER;
+        } else {
+            fillCells(row, COLUMNS_, NOTHING);
+            row[0] = row[COLUMNS_ - 1] = WALL_VERTICAL;
         }
     }
 
-    field[GAME_BEGIN_.x][GAME_BEGIN_.y] = PLAYER;
-    field[GAME_END_.x][GAME_END_.y]     = NOTHING;
+    field_[getIndex(GAME_BEGIN_)] = PLAYER;
+    field_[getIndex(GAME_END_)]   = NOTHING;
+}
+
+size_t GameField::getPackedSize() const { return (static_cast<size_t>(ROWS_ * COLUMNS_) + 7) / 8; }
+
+void GameField::saveCells(uint8_t* cells) const {
+    // один бит на клетку по строкам: 1 - блок, 0 - нет. стены по краям восстанавливаются сами.
+    // блоком стена не бывает, поэтому поле пакуется сплошь: 16 клеток - одно сравнение и маска
+    const size_t size = field_.size();
+    size_t       i    = 0;
+    std::fill(cells, cells + getPackedSize(), 0);
+#if defined(__SSE2__)
+    const __m128i block = _mm_set1_epi8(BLOCK);
+    for (; i + 16 <= size; i += 16) {
+        const __m128i row  = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&field_[i]));
+        const int     mask = _mm_movemask_epi8(_mm_cmpeq_epi8(row, block));
+        cells[i / 8]       = static_cast<uint8_t>(mask);
+        cells[i / 8 + 1]   = static_cast<uint8_t>(mask >> 8);
+    }
+#endif
+    for (; i != size; ++i) {
+        if (field_[i] == BLOCK) cells[i / 8] |= static_cast<uint8_t>(1u << (i % 8));
+    }
+}
 
-    field_ = std::move(field);
+void GameField::loadCells(const uint8_t* cells, unsigned seed) {
+    seed_ = seed;
+    buildBorders();
+
+    // обратное к saveCells: 16 бит разворачиваются в 16 байт, где бит стоит - блок, иначе клетка прежняя
+    const size_t size = field_.size();
+    size_t       i    = 0;
+#if defined(__SSE2__)
+    const __m128i block = _mm_set1_epi8(BLOCK);
+    const __m128i bits  = _mm_setr_epi8(1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128);
+    for (; i + 16 <= size; i += 16) {
+        const __m128i spread  = _mm_unpacklo_epi64(_mm_set1_epi8(static_cast<char>(cells[i / 8])),
+                                                   _mm_set1_epi8(static_cast<char>(cells[i / 8 + 1])));
+        const __m128i isBlock = _mm_cmpeq_epi8(_mm_and_si128(spread, bits), bits);
+        const __m128i row     = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&field_[i]));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(&field_[i]),
+                         _mm_or_si128(_mm_and_si128(isBlock, block), _mm_andnot_si128(isBlock, row)));
+    }
+#endif
+    for (; i != size; ++i) {
+        if (cells[i / 8] & (1u << (i % 8))) field_[i] = BLOCK;
+    }
 
-    int countGen = 1;
-    while (true) {
-        std::queue<Position> path;
-        path.push(GAME_BEGIN_);
+    calculateDistances();
+}
 
-        std::vector<std::vector<bool>> visited(ROWS_, std::vector<bool>(COLUMNS_, false));
-        visited[GAME_BEGIN_.x][GAME_BEGIN_.y] = true;
+unsigned GameField::getSeed() const { return seed_; }
 
-        generateBlocks();
+bool GameField::isPassable(Position position) const {
+    return position.x >= 0 && position.x < ROWS_ && position.y >= 0 && position.y < COLUMNS_ &&
+           (field_[getIndex(position)] == NOTHING || field_[getIndex(position)] == PLAYER);
+}
 
-        if (isPathExists(GAME_BEGIN_, path, visited)) break;
-        ++countGen;
+int GameField::getIndex(Position position) const { return position.x * COLUMNS_ + position.y; }
+
+void GameField::calculateDistances() {
+    // бывшая проверка isPathExists: путь есть, если до старта дошел поиск в ширину от финиша
+    TraceSpan span(getTracer(), "GameField::calculateDistances");
+    distances_.assign(static_cast<size_t>(ROWS_ * COLUMNS_), UNREACHABLE_DISTANCE);
+    distances_[getIndex(GAME_END_)] = 0;
+
+    std::queue<Position> queue;
+    queue.push(GAME_END_);
+    while (!queue.empty()) {
+        const Position current  = queue.front();
+        const uint16_t distance = distances_[getIndex(current)];
+        queue.pop();
+
+        for (const auto& direction : MOVE_DIRECTIONS) {
+            const Position next = {current.x + direction.offset.x, current.y + direction.offset.y};
+            if (!isPassable(next)) continue;
+            if (distances_[getIndex(next)] != UNREACHABLE_DISTANCE) continue;
+
+            distances_[getIndex(next)] = distance + 1;
+            queue.push(next);
+        }
+    }
+}
+
+void GameField::relaxDistances(const std::vector<int>& seeds) {
+    // у затравок расстояния разные, поэтому очередь с приоритетом, а не обычная
+    using Item = std::pair<uint16_t, int>;
+    std::priority_queue<Item, std::vector<Item>, std::greater<Item>> queue;
+    for (const int seed : seeds) {
+        if (distances_[seed] != UNREACHABLE_DISTANCE) queue.push({distances_[seed], seed});
+    }
+
+    while (!queue.empty()) {
+        const auto [distance, index] = queue.top();
+        queue.pop();
+        if (distance != distances_[index]) continue;  // уже нашли короче
+
+        const Position current = {index / COLUMNS_, index % COLUMNS_};
+        for (const auto& direction : MOVE_DIRECTIONS) {
+            const Position next = {current.x + direction.offset.x, current.y + direction.offset.y};
+            if (!isPassable(next)) continue;
+
+            const int nextIndex = getIndex(next);
+            if (distances_[nextIndex] <= distance + 1) continue;
+            distances_[nextIndex] = distance + 1;
+            queue.push({distances_[nextIndex], nextIndex});
+        }
+    }
+}
+
+uint16_t GameField::getDistance(Position position) const { return distances_[getIndex(position)]; }
+
+const MoveDirection* GameField::getHint(Position position) const {
+    // лучший ход - в соседа, который на один ход ближе к финишу
+    const uint16_t distance = getDistance(position);
+    if (distance == 0 || distance == UNREACHABLE_DISTANCE) return nullptr;
+
+    for (const auto& direction : MOVE_DIRECTIONS) {
+        const Position next = {position.x + direction.offset.x, position.y + direction.offset.y};
+        if (!isPassable(next)) continue;
+        if (distances_[getIndex(next)] == distance - 1) return &direction;
+    }
+
+    return nullptr;
+}
+
+void GameField::setBlock(Position position, bool isBlocked) {
+    // открытая клетка может только уменьшить расстояния: пересчитываем от нее наружу.
+    // закрытая может только увеличить: сначала сбрасываем клетки, которые держались только на ней,
+    // затем заново заполняем их от уцелевших соседей
+    if (position.x <= 0 || position.x >= ROWS_ - 1 || position.y <= 0 || position.y >= COLUMNS_ - 1)
+        throw std::invalid_argument("Error: only inner cells can be changed!");
+    if (isBlocked == (field_[getIndex(position)] == BLOCK) || field_[getIndex(position)] == PLAYER) return;
+
+    auto forEachNeighbour = [this](int index, auto&& action) {
+        const Position current = {index / COLUMNS_, index % COLUMNS_};
+        for (const auto& direction : MOVE_DIRECTIONS) {
+            const Position next = {current.x + direction.offset.x, current.y + direction.offset.y};
+            if (isPassable(next)) action(getIndex(next));
+        }
+    };
+    auto bestFromNeighbours = [&](int index) {
+        uint16_t best = UNREACHABLE_DISTANCE;
+        forEachNeighbour(index, [&](int next) {
+            if (distances_[next] != UNREACHABLE_DISTANCE && distances_[next] + 1 < best) best = distances_[next] + 1;
+        });
+        return best;
+    };
+
+    const int index = getIndex(position);
+    if (!isBlocked) {
+        field_[index]     = NOTHING;
+        distances_[index] = bestFromNeighbours(index);
+        relaxDistances({index});
+        return;
+    }
+
+    const uint16_t oldDistance = distances_[index];
+    field_[index]              = BLOCK;
+    distances_[index]          = UNREACHABLE_DISTANCE;
+    if (oldDistance == UNREACHABLE_DISTANCE) return;
+
+    // обход слоями по старым расстояниям: опора клетки (сосед на один ход ближе) всегда проверена раньше нее
+    std::queue<int>  queue;
+    std::vector<int> invalidated;
+    for (queue.push(index); !queue.empty(); queue.pop()) {
+        const int      current  = queue.front();
+        const uint16_t distance = current == index ? oldDistance : distances_[current];
+        if (current != index) {
+            if (distance == UNREACHABLE_DISTANCE) continue;
+
+            bool isSupported = false;
+            forEachNeighbour(current, [&](int next) { isSupported |= distances_[next] + 1 == distance; });
+            if (isSupported) continue;
+
+            distances_[current] = UNREACHABLE_DISTANCE;
+            invalidated.push_back(current);
+        }
+
+        forEachNeighbour(current, [&](int next) {
+            if (distances_[next] == distance + 1) queue.push(next);
+        });
     }
 
-    app->writeLog("GameField::calculateGameField | " + std::to_string(countGen) +
-                  " attempts required for maze generation.");
+    for (const int current : invalidated) distances_[current] = bestFromNeighbours(current);
+    relaxDistances(invalidated);
 }
 
+GameField::GameField(const int _ROWS, const int _COLUMNS, LogComponent& logComponent)
+    : ROWS_(_ROWS),
+      COLUMNS_(_COLUMNS),
+      GAME_BEGIN_({_ROWS / 2, 0}),
+      GAME_END_({_ROWS / 2, _COLUMNS - 1}),
+      seed_(0),
+      logComponent_(&logComponent) {}
+
 GameField::GameField(const int _ROWS, const int _COLUMNS)
-    : ROWS_(_ROWS), COLUMNS_(_COLUMNS), GAME_BEGIN_({_ROWS / 2, 0}), GAME_END_({_ROWS / 2, _COLUMNS - 1}) {}
+    : ROWS_(_ROWS),
+      COLUMNS_(_COLUMNS),
+      GAME_BEGIN_({_ROWS / 2, 0}),
+      GAME_END_({_ROWS / 2, _COLUMNS - 1}),
+      seed_(0),
+      logComponent_(nullptr) {}
 
 void GameField::display() const {
+    TraceSpan span(getTracer(), "GameField::display");
     for (int i = 0; i != ROWS_; ++i) {
         for (int j = 0; j != COLUMNS_; ++j) {
-            std::cout << field_[i][j] << ' ';
+            std::cout << field_[getIndex({i, j})] << ' ';
 
             if (i == GAME_END_.x && j == GAME_END_.y) std::cout << "<- FINISH";
             // явно указываем, где финиш
         }
 
-        std::cout << std::endl;
+        std::cout << '\n';
     }
+    std::cout << std::flush;  // кадр целиком одной записью, а не построчно
 }
 
-void GameField::clearPlayerPosition(Position position) { field_[position.x][position.y] = NOTHING; }
+void GameField::clearPlayerPosition(Position position) { field_[getIndex(position)] = NOTHING; }
 
 void GameField::clearScreen() const { std::cout << "\033[2J\033[1;1H"; }
 
-bool GameField::isWalkable(int x, int y) const { return field_[x][y] == NOTHING; }
+bool GameField::isWalkable(int x, int y) const { return field_[getIndex({x, y})] == NOTHING; }
+
+bool GameField::canMove(Position position) const {
+    return position.x >= 0 && position.x < ROWS_ && position.y >= 0 && position.y < COLUMNS_ &&
+           isWalkable(position.x, position.y);
+}
+
+void GameField::setPlayerPosition(Position position) { field_[getIndex(position)] = PLAYER; }
+
+Tracer* GameField::getTracer() const { return logComponent_ != nullptr ? logComponent_->getTracer() : nullptr; }
+
+int GameField::getRows() const { return ROWS_; }
+
+int GameField::getColumns() const { return COLUMNS_; }
 
-void GameField::setPlayerPosition(Position position) { field_[position.x][position.y] = PLAYER; }
\ No newline at end of file
+Position GameField::getFinish() const { return GAME_END_; }
\ No newline at end of file
@@ -1,29 +1,61 @@
 #pragma once
 
+#include <logger/logger.h>
+
+#include <cstdint>
 #include <ctime>
 #include <iostream>
 #include <queue>
+#include <random>
 #include <vector>
 
 #include "position.h"
+#include "scheduler.h"
+
+constexpr uint16_t UNREACHABLE_DISTANCE = UINT16_MAX;  // до финиша не дойти
 
 class GameField {
    private:
     int                            ROWS_, COLUMNS_;         // размеры игрового поля
     Position                       GAME_BEGIN_, GAME_END_;  // стартовая позиция и финиш
-    std::vector<std::vector<char>> field_;                  // игровое поле
+    std::vector<char>              field_;                  // игровое поле по строкам ROWS_ x COLUMNS_, рамка - стены
+    std::vector<uint16_t>          distances_;              // число ходов до финиша, по строкам ROWS_ x COLUMNS_
+    unsigned                       seed_;                   // зерно, из которого получен лабиринт
+    LogComponent*                  logComponent_;           // компонент журнала "GameField"
 
-    bool isPathExists(Position currentPos, std::queue<Position>& path,
-                      std::vector<std::vector<bool>>& visited);  // хотя бы один путь существует
-    void generateBlocks();  // генерация блоков в игровом поле
+    void    buildBorders();                                      // пустое поле со стенами и игроком на старте
+    void    generateBlocks(std::mt19937& random);                // генерация блоков в игровом поле
+    void    calculateDistances();                                // поиск в ширину от финиша по всему полю
+    bool    generateAttempt(std::mt19937& random, int attempt);  // одна попытка: блоки и поиск пути до финиша
+    int     getIndex(Position position) const;                   // номер клетки в distances_
+    void    relaxDistances(const std::vector<int>& seeds);       // уменьшить расстояния от клеток seeds наружу
+    Tracer* getTracer() const;                                   // трассировщик журнала, nullptr - поле без журнала
 
    public:
-    GameField(const int _ROWS, const int _COLUMNS);
+    GameField(const int _ROWS, const int _COLUMNS, LogComponent& logComponent);
+    GameField(const int _ROWS, const int _COLUMNS);  // без журнала, для симуляции
+
+    Task<> calculateGameField(TaskScheduler& scheduler);  // генерация для игры, между попытками отдает поток
 
-    void calculateGameField();  // основной метод для генерации игрового поля
-    void display() const;       // вывод всего поля в консоль
-    void clearScreen() const;   // очистка консоли
+    int  generate(unsigned seed);                 // генерация по зерну без журнала, возвращает число попыток
+    void display() const;                         // вывод всего поля в консоль
+    void clearScreen() const;                     // очистка консоли
     bool isWalkable(int x, int y) const;          // можно ли сходить в эту позицию
+    bool canMove(Position position) const;        // позиция внутри поля и свободна
+    bool isPassable(Position position) const;     // внутри поля, не стена и не блок (игрок не мешает)
     void clearPlayerPosition(Position position);  // очистка позиции игрока
     void setPlayerPosition(Position position);    // установка позиции игрока
+
+    int      getRows() const;     // число строк
+    int      getColumns() const;  // число столбцов
+    Position getFinish() const;   // финиш на правой стене
+
+    uint16_t             getDistance(Position position) const;  // ходов до финиша, UNREACHABLE_DISTANCE - не дойти
+    const MoveDirection* getHint(Position position) const;      // лучший ход, nullptr - на финише или не дойти
+    void setBlock(Position position, bool isBlocked);  // изменить клетку, расстояния обновляются только вокруг нее
+
+    size_t   getPackedSize() const;                           // байт на поле в упакованном виде (бит на клетку)
+    void     saveCells(uint8_t* cells) const;                 // упаковать блоки, getPackedSize байт
+    void     loadCells(const uint8_t* cells, unsigned seed);  // восстановить поле из упакованного, игрок на старте
+    unsigned getSeed() const;  // зерно: по нему generate построит тот же лабиринт
 };
\ No newline at end of file
@@ -0,0 +1,134 @@
+#include "input.h"
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdint>
+#include <stdexcept>
+
+InputReader::InputReader(int fd)
+    : fd_(fd),
+      isRawMode_(false),
+      savedTermios_{},
+      wakeFd_(-1),
+      stopPipe_{-1, -1},
+      keys_{},
+      head_(0),
+      tail_(0),
+      isClosed_(false),
+      escapeState_(0) {
+    wakeFd_ = eventfd(0, EFD_CLOEXEC);
+    if (wakeFd_ < 0) throw std::runtime_error("Error: creating input eventfd!");
+    if (pipe2(stopPipe_, O_CLOEXEC) != 0) {
+        close(wakeFd_);
+        throw std::runtime_error("Error: creating input pipe!");
+    }
+
+    // ICANON - построчный ввод, ECHO - эхо; сигналы (Ctrl-C) оставляем терминалу
+    if (isatty(fd_) && tcgetattr(fd_, &savedTermios_) == 0) {
+        termios raw = savedTermios_;
+        raw.c_lflag &= ~static_cast<tcflag_t>(ICANON | ECHO);
+        raw.c_cc[VMIN]  = 1;
+        raw.c_cc[VTIME] = 0;
+        isRawMode_      = tcsetattr(fd_, TCSANOW, &raw) == 0;
+    }
+
+    readThread_ = std::thread([this]() { readLoop(); });
+}
+
+InputReader::~InputReader() {
+    (void)!write(stopPipe_[1], "s", 1);
+    readThread_.join();
+
+    if (isRawMode_) tcsetattr(fd_, TCSANOW, &savedTermios_);
+
+    close(wakeFd_);
+    close(stopPipe_[0]);
+    close(stopPipe_[1]);
+}
+
+void InputReader::readLoop() {
+    pollfd fds[2] = {{fd_, POLLIN, 0}, {stopPipe_[0], POLLIN, 0}};
+
+    while (!isClosed_.load()) {
+        if (poll(fds, 2, -1) < 0) continue;  // EINTR
+        if (fds[1].revents & POLLIN) break;
+        if ((fds[0].revents & (POLLIN | POLLHUP)) == 0) continue;
+
+        // всё, что пришло пачкой (зажатая клавиша, вставка), становится одним пробуждением
+        char          buffer[64];
+        const ssize_t size = read(fd_, buffer, sizeof(buffer));
+        if (size < 0 && (errno == EINTR || errno == EAGAIN)) continue;
+        if (size <= 0) {
+            isClosed_.store(true);
+        } else {
+            for (ssize_t i = 0; i != size && !isClosed_.load(); ++i) decode(buffer[i]);
+        }
+        notify();
+    }
+}
+
+void InputReader::decode(char symbol) {
+    // стрелки приходят как ESC [ A..D, их превращаем в wasd
+    if (escapeState_ == 1) {
+        escapeState_ = symbol == '[' ? 2 : 0;
+        if (escapeState_ == 2) return;
+    } else if (escapeState_ == 2) {
+        escapeState_ = 0;
+        if (symbol == 'A') push('w');
+        if (symbol == 'B') push('s');
+        if (symbol == 'C') push('d');
+        if (symbol == 'D') push('a');
+        return;
+    }
+
+    if (symbol == '\033') {
+        escapeState_ = 1;
+    } else if (symbol == INPUT_EOF_KEY) {
+        isClosed_.store(true);
+    } else if (symbol != '\n' && symbol != '\r' && symbol != ' ') {
+        push(symbol);
+    }
+}
+
+void InputReader::push(char key) {
+    const size_t tail = tail_.load(std::memory_order_relaxed);
+    if (tail - head_.load(std::memory_order_acquire) == INPUT_QUEUE_SIZE) return;  // игра не успевает
+
+    keys_[tail & (INPUT_QUEUE_SIZE - 1)] = key;
+    tail_.store(tail + 1, std::memory_order_release);
+}
+
+void InputReader::notify() {
+    const uint64_t one = 1;
+    (void)!write(wakeFd_, &one, sizeof(one));
+}
+
+bool InputReader::waitKeys(std::string& keys, int timeoutMs) {
+    auto drain = [this, &keys]() {
+        const size_t head = head_.load(std::memory_order_relaxed);
+        const size_t tail = tail_.load(std::memory_order_acquire);
+        for (size_t i = head; i != tail; ++i) keys += keys_[i & (INPUT_QUEUE_SIZE - 1)];
+        head_.store(tail, std::memory_order_release);
+        return tail != head;
+    };
+
+    if (drain()) return true;
+    if (isClosed_.load()) return drain();
+
+    // читатель сначала кладет клавиши, потом будит: после пробуждения они уже видны
+    pollfd wake = {wakeFd_, POLLIN, 0};
+    if (poll(&wake, 1, timeoutMs) > 0) {
+        uint64_t count;
+        (void)!read(wakeFd_, &count, sizeof(count));
+    }
+
+    return drain() || !isClosed_.load();
+}
+
+bool InputReader::isRawMode() const { return isRawMode_; }
+
+int InputReader::getWakeFd() const { return wakeFd_; }
\ No newline at end of file
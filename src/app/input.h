@@ -0,0 +1,42 @@
+#pragma once
+
+#include <termios.h>
+
+#include <atomic>
+#include <string>
+#include <thread>
+
+// посимвольный ввод без Enter: терминал в неканоническом режиме без эха,
+// отдельный поток ждет stdin через poll и кладет клавиши в очередь без блокировок,
+// игровой цикл забирает всё накопленное разом и рисует поле один раз
+
+constexpr size_t INPUT_QUEUE_SIZE = 64;      // степень двойки; при переполнении клавиши отбрасываются
+constexpr char   INPUT_EOF_KEY    = '\x04';  // Ctrl-D
+
+class InputReader {  // клавиши из терминала или канала в очередь для игрового цикла
+   private:
+    int                 fd_;                      // откуда читаем (stdin или канал в тестах)
+    bool                isRawMode_;               // терминал переведен в неканонический режим
+    termios             savedTermios_;            // настройки терминала для восстановления
+    int                 wakeFd_;                  // eventfd: читатель будит игровой поток
+    int                 stopPipe_[2];             // остановка потока чтения
+    char                keys_[INPUT_QUEUE_SIZE];  // кольцевая очередь: один писатель, один читатель
+    std::atomic<size_t> head_;                    // следующая клавиша для игрового потока
+    std::atomic<size_t> tail_;                    // следующая свободная ячейка для потока чтения
+    std::atomic<bool>   isClosed_;                // ввод закончился (EOF, Ctrl-D)
+    std::thread         readThread_;              // поток чтения
+    int                 escapeState_;             // разбор стрелок: ESC [ A..D
+
+    void readLoop();           // ожидание и чтение ввода
+    void decode(char symbol);  // байт ввода -> клавиша в очереди
+    void push(char key);       // в очередь, без блокировок
+    void notify();             // разбудить игровой поток
+
+   public:
+    explicit InputReader(int fd);  // в посимвольный режим терминал переводится, только если это tty
+    ~InputReader();                // возвращает настройки терминала
+
+    bool waitKeys(std::string& keys, int timeoutMs = -1);  // дописать накопленные клавиши, false - ввод закончился
+    bool isRawMode() const;                                // терминал в посимвольном режиме
+    int  getWakeFd() const;  // готов к чтению, когда появились клавиши: для ожидания в планировщике задач
+};
\ No newline at end of file
@@ -1,6 +1,13 @@
+#include <logger/affinity.h>
+#include <logger/configwatcher.h>
+
+#include <chrono>
+#include <csignal>
 #include <iostream>
 
+#include "bot.h"
 #include "manager.h"
+#include "server.h"
 
 LogLevel convertToLogLevel(const std::string& logLevelString) {
     // так как работаем с перечислениями, а в аргументах строка, то переводим её
@@ -15,20 +22,249 @@ LogLevel convertToLogLevel(const std::string& logLevelString) {
         throw std::invalid_argument("Invalid log level: " + logLevelString);
 }
 
+void configureLogLane(const std::string& value) {
+    // <level>:<capacity>:<policy>, например INFO:4096:drop-oldest
+    const size_t first = value.find(':'), second = value.find(':', first + 1);
+    if (first == std::string::npos || second == std::string::npos)
+        throw std::invalid_argument("Invalid log lane: " + value);
+
+    const std::string policy = value.substr(second + 1);
+    LaneDropPolicy    dropPolicy;
+    if (policy == "block")
+        dropPolicy = LANE_BLOCK;
+    else if (policy == "drop-newest")
+        dropPolicy = LANE_DROP_NEWEST;
+    else if (policy == "drop-oldest")
+        dropPolicy = LANE_DROP_OLDEST;
+    else
+        throw std::invalid_argument("Invalid log lane policy: " + policy);
+
+    app->configureLogLane(convertToLogLevel(value.substr(0, first)),
+                          std::stoul(value.substr(first + 1, second - first - 1)), dropPolicy);
+}
+
 std::unique_ptr<MultithreadAppManager> app = nullptr;
 
+GameServer* runningServer = nullptr;  // для остановки сервера по SIGINT/SIGTERM
+
+void stopServerHandler(int) {
+    if (runningServer != nullptr) runningServer->stop();
+}
+
 int main(int argc, char* argv[]) {
     // работаем с параметрами командной строки
     if (argc < 3) {
-        std::cerr << "Usage: " << argv[0] << " <log_file> <log_level>\n";
+        std::cerr << "Usage: " << argv[0]
+                  << " <log_file> <log_level> [<component>=<log_level> ...] [--config=<file>]"
+                     " [--server=<socket> [--workers=<count>]]"
+                     " [--maze-pack=<file>] [--make-maze-pack=<file> [--maze-count=<count>]]"
+                     " [--record=<file>] [--replay=<file>] [--raw-input] [--workers=<count>]"
+                     " [--bots=<count> [--bot-strategy=random|wall|astar] [--workers=<count>]]"
+                     " [--dynamic-maze=<changes per second>]"
+                     " [--log-lane=<level>:<capacity>:block|drop-newest|drop-oldest ...] [--log-clock=tsc|coarse]"
+                     " [--trace=<file.json>] [--shared-log=<name>]"
+                     " [--worker-cpus=<list>] [--log-bench=<producers>[:<records>]]\n";
         return 1;
     }
 
     // в обертке инициализируем наше многопоточное приложение
     // передаем аргументы командной строки и запускаем
     try {
-        app = std::make_unique<MultithreadAppManager>(argv[1], convertToLogLevel(argv[2]));
-        app->run();
+        // источник времени журнала нужен до его создания, остальные параметры - после
+        LogClockSource clockSource = LOG_CLOCK_TSC;
+        for (int i = 3; i < argc; ++i) {
+            if (std::string(argv[i]) == "--log-clock=coarse") clockSource = LOG_CLOCK_COARSE;
+        }
+
+        app = std::make_unique<MultithreadAppManager>(argv[1], convertToLogLevel(argv[2]), SAFELY, clockSource);
+        app->logger_->enableFlightRecorder(std::string(argv[1]) + ".crash");  // последние записи при падении
+
+        // уровни отдельных компонентов, например GameField=INFO
+        // и файл настроек, который перечитывается на лету (--config=logger.conf)
+        // --server=<socket> вместо одной игры в консоли запускает сервер на много игр
+        // --maze-pack=<file> берет готовые лабиринты из набора, --make-maze-pack=<file> создает набор
+        // --record=<file> записывает игру, --replay=<file> повторяет запись без задержек и заново пишет журнал
+        // --raw-input - ходы по нажатию клавиши (wasd или стрелки) без Enter
+        // --bots=<count> вместо игры запускает ботов на пуле потоков: нагрузка на журнал, как от игроков
+        // --dynamic-maze=<n> - блоки появляются и исчезают n раз в секунду, путь до финиша остается
+        // --log-lane=INFO:4096:drop-oldest - размер очереди уровня и что делать при ее переполнении
+        // --log-clock=tsc|coarse - чем производители отмечают время записи (TSC - если процессор позволяет)
+        // --trace=<file.json> - отрезки времени генерации, отрисовки и записи журнала для chrome://tracing
+        // --shared-log=/game - писать в общий журнал нескольких процессов, который ведет logcollector
+        // --workers=<count> - потоки сервера, ботов или (без них) рабочие потоки задач одной игры, там по умолчанию 2
+        // --worker-cpus=0-3,8 - рабочие потоки задач по одному на процессор из списка, по кругу
+        // --log-bench=<producers>[:<records>] - вместо игры нагрузка на очереди журнала, без привязки и с ней
+        std::unique_ptr<LogConfigWatcher> configWatcher;
+        std::string                       socketPath, mazePackPath, newMazePackPath, recordPath, replayPath;
+        std::string                       tracePath;
+        std::string                       botStrategy = "astar";
+        size_t                            workerCount = 4, mazeCount = 1000, botCount = 0;
+        size_t                            benchProducers = 0, benchRecords = LOG_BENCH_RECORDS;
+        std::vector<int>                  workerCpus;
+        for (int i = 3; i < argc; ++i) {
+            const std::string argument = argv[i];
+            if (argument.rfind("--config=", 0) == 0) {
+                configWatcher = std::make_unique<LogConfigWatcher>(*app->logger_, argument.substr(9));
+                LogConfigWatcher::installSighupHandler();
+                continue;
+            }
+            if (argument.rfind("--server=", 0) == 0) {
+                socketPath = argument.substr(9);
+                continue;
+            }
+            if (argument.rfind("--workers=", 0) == 0) {
+                workerCount = std::stoul(argument.substr(10));
+                app->useWorkers(workerCount);
+                continue;
+            }
+            if (argument.rfind("--maze-pack=", 0) == 0) {
+                mazePackPath = argument.substr(12);
+                continue;
+            }
+            if (argument.rfind("--make-maze-pack=", 0) == 0) {
+                newMazePackPath = argument.substr(17);
+                continue;
+            }
+            if (argument.rfind("--maze-count=", 0) == 0) {
+                mazeCount = std::stoul(argument.substr(13));
+                continue;
+            }
+            if (argument.rfind("--record=", 0) == 0) {
+                recordPath = argument.substr(9);
+                continue;
+            }
+            if (argument.rfind("--replay=", 0) == 0) {
+                replayPath = argument.substr(9);
+                continue;
+            }
+            if (argument.rfind("--bots=", 0) == 0) {
+                botCount = std::stoul(argument.substr(7));
+                continue;
+            }
+            if (argument.rfind("--bot-strategy=", 0) == 0) {
+                botStrategy = argument.substr(15);
+                continue;
+            }
+            if (argument.rfind("--dynamic-maze=", 0) == 0) {
+                app->useDynamicMaze(std::stod(argument.substr(15)));
+                continue;
+            }
+            if (argument.rfind("--log-lane=", 0) == 0) {
+                configureLogLane(argument.substr(11));
+                continue;
+            }
+            if (argument.rfind("--trace=", 0) == 0) {
+                tracePath = argument.substr(8);
+                app->logger_->enableTracing();
+                continue;
+            }
+            if (argument.rfind("--shared-log=", 0) == 0) {
+                app->logger_->attachSharedLog(argument.substr(13));
+                continue;
+            }
+            if (argument.rfind("--log-clock=", 0) == 0) {
+                if (argument != "--log-clock=tsc" && argument != "--log-clock=coarse")
+                    throw std::invalid_argument("Invalid log clock: " + argument.substr(12));
+                continue;
+            }
+            if (argument.rfind("--worker-cpus=", 0) == 0) {
+                workerCpus = parseCpuList(argument.substr(14));
+                continue;
+            }
+            if (argument.rfind("--log-bench=", 0) == 0) {
+                const std::string value = argument.substr(12);
+                const size_t      colon = value.find(':');
+                benchProducers          = std::stoul(value.substr(0, colon));
+                if (colon != std::string::npos) benchRecords = std::stoul(value.substr(colon + 1));
+                continue;
+            }
+            if (argument == "--raw-input") {
+                app->useRawInput();
+                continue;
+            }
+
+            const size_t equal = argument.find('=');
+            if (equal == std::string::npos) throw std::invalid_argument("Invalid component level: " + argument);
+
+            app->logger_->getComponent(argument.substr(0, equal))
+                .changeLogLevel(convertToLogLevel(argument.substr(equal + 1)));
+        }
+
+        if (!workerCpus.empty()) app->pinWorkers(workerCpus);
+
+        if (!newMazePackPath.empty()) {
+            writeMazePack(newMazePackPath, static_cast<uint32_t>(mazeCount));
+            std::cout << "Maze pack saved: " << newMazePackPath << " (" << mazeCount << " mazes)\n";
+        } else if (benchProducers != 0) {
+            // один и тот же прогон без привязки потоков и, если задан список процессоров, с ней;
+            // журнал каждого прогона - рядом с основным: game_log_bench.txt, game_log_pinned.txt
+            const std::string logPath   = argv[1];
+            const size_t      extension = logPath.rfind('.');
+            for (const bool isPinned : {false, true}) {
+                if (isPinned && workerCpus.empty()) break;
+
+                MultithreadAppManager bench(logPath.substr(0, extension) + (isPinned ? "_pinned" : "_bench") +
+                                                logPath.substr(extension),
+                                            convertToLogLevel(argv[2]), FAST, clockSource);
+                bench.useWorkers(workerCount);
+                if (isPinned) bench.pinWorkers(workerCpus);
+                const LogBenchmarkReport report = bench.runLogBenchmark(benchProducers, benchRecords);
+                const double seconds = std::max(std::chrono::duration<double>(report.elapsed).count(), 1e-9);
+
+                std::cout << (isPinned ? "Pinned to " + formatCpuList(workerCpus) : std::string("Unpinned")) << ": "
+                          << report.records << " records, " << static_cast<double>(report.records) / seconds
+                          << " records/sec, latency p99 " << report.info.p99Latency.count() << " ns, max "
+                          << report.info.maxLatency.count() << " ns\n";
+            }
+        } else if (botCount != 0) {
+            const BotReport report = runBots(&app->logger_->getComponent("Player"), botStrategy, botCount, workerCount);
+            const double    seconds = std::max(std::chrono::duration<double>(report.elapsed).count(), 1e-9);
+
+            std::cout << "Bots: " << report.botCount << ", finished: " << report.finishedCount
+                      << ", moves: " << report.moveCount << " (failed " << report.failedMoves << "), "
+                      << static_cast<double>(report.moveCount) / seconds << " moves/sec\n";
+        } else if (!replayPath.empty()) {
+            const SessionRecording recording = loadSession(replayPath);
+            const auto             start     = std::chrono::steady_clock::now();
+            const SimulationResult result    = replaySession(recording, &app->logger_->getComponent("Player"));
+            const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+            std::cout << "Replayed " << recording.moves.size() << " moves, final position " << result.position.x
+                      << ";" << result.position.y << (result.isFinished ? " (finished)" : "") << ", "
+                      << static_cast<double>(recording.moves.size()) / std::max(elapsed.count(), 1e-9)
+                      << " moves/sec\n";
+        } else if (socketPath.empty()) {
+            if (!mazePackPath.empty()) app->useMazePack(mazePackPath);
+            if (!recordPath.empty()) {
+                // в записи только ходы: изменения лабиринта при повторе не воспроизвести
+                if (app->getMazeMutationRate() > 0)
+                    throw std::invalid_argument("Error: dynamic maze cannot be recorded!");
+                app->recordSession(recordPath);
+            }
+            // без синхронизации с stdio std::cin читает дескриптор сам и знает, сколько в буфере:
+            // игра ждет готовности stdin в планировщике, а не в блокирующем чтении
+            std::ios::sync_with_stdio(false);
+            app->run();
+        } else {
+            std::unique_ptr<MazePack> mazePack;
+            std::unique_ptr<MazePool> mazePool;
+            if (!mazePackPath.empty()) {
+                mazePack = std::make_unique<MazePack>(mazePackPath);
+                mazePool = std::make_unique<MazePool>(mazePack.get(), 64);
+            }
+
+            GameServer server(socketPath, *app->logger_, workerCount, mazePool.get());
+            runningServer = &server;
+            std::signal(SIGINT, stopServerHandler);
+            std::signal(SIGTERM, stopServerHandler);
+            server.run();
+            runningServer = nullptr;
+        }
+
+        if (!tracePath.empty()) {
+            const size_t count = app->logger_->getTracer()->writeChromeTrace(tracePath);
+            std::cout << "Trace saved: " << tracePath << " (" << count << " spans)\n";
+        }
     } catch (const std::exception& e) {
         std::cerr << e.what() << std::endl;
         return 1;
@@ -1,74 +1,461 @@
 #include "manager.h"
 
-MultithreadAppManager::MultithreadAppManager(const std::string& logFilename, LogLevel logLevel, LogType logType)
-    : logger_(std::make_unique<Logger>(logFilename, logLevel, logType)),
-      gameField_(std::make_unique<GameField>(ROWS, COLUMNS)),
-      player_(std::make_unique<Player>(gameField_.get())),
-      logThreadRunning_(true),
-      mazeGeneratedThread_(false) {}
+#include <logger/affinity.h>
+
+#include <algorithm>
+#include <iterator>
+#include <thread>
+
+namespace {
+
+std::unique_ptr<LogNode> makeLogNode() {
+    // буферы полос и пачек резервируются здесь же: задача журнала меняет их местами, но не растит,
+    // а дальше их растят производители, то есть потоки того же узла
+    auto node          = std::make_unique<LogNode>();
+    node->infoPosition = 0;
+    node->isClosed     = false;
+    for (size_t level = 0; level != LOG_LANE_COUNT; ++level) {
+        LogLane& lane   = node->lanes[level];
+        lane.head       = 0;
+        lane.capacity   = LOG_LANE_CAPACITY;
+        lane.dropPolicy = LANE_BLOCK;
+        lane.dropped    = 0;
+        lane.written    = 0;
+        lane.maxLatency = 0;
+        std::fill(std::begin(lane.latency), std::end(lane.latency), 0);
+        lane.queue.reserve(LOG_LANE_CHUNK);
+        node->batches[level].reserve(LOG_LANE_CHUNK);
+    }
+    return node;
+}
+
+}  // namespace
+
+MultithreadAppManager::MultithreadAppManager(const std::string& logFilename, LogLevel logLevel, LogType logType,
+                                             LogClockSource clockSource)
+    : logger_(std::make_unique<Logger>(logFilename, logLevel, logType, TEXT, clockSource)),
+      appLog_(&logger_->getComponent("APP")),
+      gameField_(std::make_unique<GameField>(ROWS, COLUMNS, logger_->getComponent("GameField"))),
+      player_(std::make_unique<Player>(gameField_.get(), logger_->getComponent("Player"))),
+      rawInput_(false),
+      mazeMutationRate_(0),
+      scheduler_(std::make_unique<TaskScheduler>()),
+      isLogRunning_(true),
+      isMazeGenerated_(false),
+      playableLatency_(-1) {
+    // очередь на каждый узел NUMA. узел создает поток, привязанный к процессорам этого узла: ядро выделяет
+    // страницу узлу, который первым её коснулся, так что мьютекс, полосы и их первые буферы ложатся в его память
+    const int nodeCount = getNodeCount();
+    for (int i = 0; i != nodeCount; ++i) {
+        std::vector<int> cpus;
+        if (nodeCount != 1) {
+            const std::vector<int> nodeCpus = getNodeCpus(i), allowed = getThreadCpus();
+            std::copy_if(nodeCpus.begin(), nodeCpus.end(), std::back_inserter(cpus), [&allowed](int cpu) {
+                return std::binary_search(allowed.begin(), allowed.end(), cpu);
+            });
+        }
+        if (cpus.empty()) {
+            logNodes_.push_back(makeLogNode());
+            continue;
+        }
+
+        std::unique_ptr<LogNode> node;
+        std::thread([&node, &cpus]() {
+            try {
+                pinCurrentThread(cpus);
+            } catch (const std::runtime_error&) {
+                // не привязались - узел всё равно нужен, только память его где придется
+            }
+            node = makeLogNode();
+        }).join();
+        logNodes_.push_back(std::move(node));
+    }
+}
+
+void MultithreadAppManager::useMazePack(const std::string& filename) {
+    // набор отображается в память, лабиринт из него готов сразу, а начинаем со случайного места
+    mazePack_ = std::make_unique<MazePack>(filename);
+    if (mazePack_->getCount() == 0) throw std::runtime_error("Error: maze pack is empty!");
+
+    const auto now = static_cast<uint32_t>(time(nullptr));
+    mazePool_      = std::make_unique<MazePool>(mazePack_.get(), 1, now % mazePack_->getCount(), now);
+}
+
+void MultithreadAppManager::recordSession(const std::string& filename) {
+    sessionRecorder_ = std::make_unique<SessionRecorder>(filename);
+}
+
+SessionRecorder* MultithreadAppManager::getSessionRecorder() const { return sessionRecorder_.get(); }
+
+void MultithreadAppManager::useRawInput() { rawInput_ = true; }
+
+bool MultithreadAppManager::isRawInput() const { return rawInput_; }
+
+void MultithreadAppManager::useDynamicMaze(double changesPerSecond) {
+    if (changesPerSecond < 0) throw std::invalid_argument("Invalid maze mutation rate!");
+    mazeMutationRate_ = changesPerSecond;
+}
+
+double MultithreadAppManager::getMazeMutationRate() const { return mazeMutationRate_; }
+
+void MultithreadAppManager::configureLogLane(LogLevel logLevel, size_t capacity, LaneDropPolicy dropPolicy) {
+    // емкость - у полосы каждого узла
+    if (capacity == 0) throw std::invalid_argument("Invalid log lane capacity!");
+    for (auto& node : logNodes_) {
+        node->lanes[logLevel].capacity   = capacity;
+        node->lanes[logLevel].dropPolicy = dropPolicy;
+    }
+}
+
+LogLaneStats MultithreadAppManager::getLogLaneStats(LogLevel logLevel) const {
+    // полосы уровня на всех узлах складываются в одну
+    LogLaneStats stats{0, 0, std::chrono::nanoseconds(0), std::chrono::nanoseconds(0)};
+    size_t       latency[std::size(LogLane().latency)] = {};
+    for (const auto& node : logNodes_) {
+        const LogLane& lane = node->lanes[logLevel];
+        stats.written += lane.written;
+        stats.dropped += lane.dropped;
+        stats.maxLatency = std::max(stats.maxLatency, std::chrono::nanoseconds(lane.maxLatency));
+        for (size_t i = 0; i != std::size(latency); ++i) latency[i] += lane.latency[i];
+    }
+
+    // верхняя граница корзины, до которой набирается 99% записей
+    size_t seen = 0;
+    for (size_t i = 0; i != std::size(latency) && stats.written != 0; ++i) {
+        seen += latency[i];
+        if (seen * 100 >= stats.written * 99) {
+            stats.p99Latency = std::min(std::chrono::nanoseconds(int64_t(2) << i), stats.maxLatency);
+            break;
+        }
+    }
+    return stats;
+}
+
+void MultithreadAppManager::useWorkers(size_t workerCount) {
+    scheduler_ = std::make_unique<TaskScheduler>(workerCount);
+}
+
+void MultithreadAppManager::pinWorkers(const std::vector<int>& cpus) { scheduler_->pinWorkers(cpus); }
+
+TaskScheduler& MultithreadAppManager::getScheduler() { return *scheduler_; }
 
 void MultithreadAppManager::run() {
-    // инициализация потоков через лямбды-функции
-    mazeGenerateThread_ = std::thread([this]() { runMazeGenMulti(); });
-    gameThread_         = std::thread([this]() { runGameMulti(); });
-    logThread_          = std::thread([this]() { logMulti(); });
+    // три задачи на рабочих потоках планировщика: ожидая ввода, лабиринта или сообщений,
+    // задача не держит поток. run возвращается, когда завершены все
+    startTime_ = std::chrono::steady_clock::now();
+    scheduler_->spawn(generateMaze());
+    scheduler_->spawn(playGame());
+    scheduler_->spawn(writeLogs());
+    scheduler_->run();
+}
+
+Task<> MultithreadAppManager::generateMaze() {
+    // генерируем лабиринт и будим игру, если она уже ждет
+    writeLog("APP | START TASK generateMaze");
+    if (mazePool_ != nullptr) {
+        const MazeInfo info = mazePool_->take(*gameField_);
+        writeEvent(*appLog_, LogEvent("APP", "maze {} loaded from pack, optimal solution {} moves.",
+                                      {intField("seed", info.seed), intField("solution", info.solutionLength)}));
+    } else {
+        co_await gameField_->calculateGameField(*scheduler_);
+    }
+    writeLog("APP | END TASK generateMaze");
+    isMazeGenerated_.store(true);
+    mazeReady_.notify();
+}
+
+Task<> MultithreadAppManager::playGame() {
+    // точка входа в игровую логику. журнал останавливаем последним, когда готов и лабиринт:
+    // игрок мог выйти раньше, чем закончилась генерация
+    writeLog("APP | START TASK playGame");
+    std::exception_ptr exception;
+    try {
+        co_await player_->letsgo();
+    } catch (...) {
+        exception = std::current_exception();
+    }
+    writeLog("APP | END TASK playGame");
 
-    // ожидание завершения
-    gameThread_.join();
+    while (!isMazeGenerated()) co_await mazeReady_.wait(*scheduler_);
     stopLogging();
-    logThread_.join();
-    mazeGenerateThread_.join();
+    if (exception) std::rethrow_exception(exception);
 }
 
-void MultithreadAppManager::stopMazeGenerated() {
-    mazeGeneratedThread_.store(true);  // поток сгенерирован, поэтому работаем с атомарной переменной
+LogBenchmarkReport MultithreadAppManager::runLogBenchmark(size_t producerCount, size_t recordCount) {
+    // вместо игры - producerCount задач, которые пишут события в журнал так быстро, как могут,
+    // и задача журнала. сравнивая прогоны с привязкой рабочих потоков и без, видно цену их переездов
+    if (producerCount == 0) throw std::invalid_argument("Invalid producer count: 0");
+
+    auto producersLeft = std::make_shared<std::atomic<size_t>>(producerCount);
+    for (size_t i = 0; i != producerCount; ++i) scheduler_->spawn(produceLogs(recordCount, producersLeft));
+    scheduler_->spawn(writeLogs());
+
+    const auto begin = std::chrono::steady_clock::now();
+    scheduler_->run();
+    const auto elapsed = std::chrono::steady_clock::now() - begin;
+
+    return {producerCount * recordCount, std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed),
+            getLogLaneStats(INFO)};
 }
 
-void MultithreadAppManager::runMazeGenMulti() {
-    // генерируем лабиринт и отправляем поток поспать
-    app->writeLog("APP | START THREAD runMazeGenMulti");
-    gameField_->calculateGameField();
-    app->writeLog("APP | END THREAD runMazeGenMulti");
-    stopMazeGenerated();
+Task<> MultithreadAppManager::produceLogs(size_t recordCount, std::shared_ptr<std::atomic<size_t>> producersLeft) {
+    // между пачками задача уступает поток: на одном рабочем потоке иначе журнал не получил бы его до конца
+    for (size_t i = 0; i != recordCount; ++i) {
+        writeEvent(*appLog_, LogEvent("APP", "benchmark record {}.", {intField("record", static_cast<int64_t>(i))}));
+        if (i % LOG_LANE_CHUNK == LOG_LANE_CHUNK - 1) co_await scheduler_->yield();
+    }
+    if (producersLeft->fetch_sub(1) == 1) stopLogging();
 }
 
-void MultithreadAppManager::runGameMulti() const {
-    // запускаем игровой поток через точку входа в игровую логику
-    app->writeLog("APP | START THREAD runGameMulti");
-    player_->letsgo();
-    app->writeLog("APP | END THREAD runGameMulti");
+Task<> MultithreadAppManager::writeLogs() {
+    // пока сообщений нет, задача ждет событие и не занимает рабочий поток.
+    // полосы забираем целиком и пишем уже без мьютекса, чтобы не задерживать производителей.
+    // ERROR и WARNING пишутся первыми и сразу сбрасываются в файл; INFO ждет пачки не дольше LOG_LAZY_DELAY
+    // и пишется частями по LOG_LANE_CHUNK, между которыми задача уступает поток и забирает новые ошибки.
+    // узлы NUMA пишутся по очереди: строки разных узлов в одном проходе идут группами, время у каждой свое
+    writeLog("APP | START TASK writeLogs");
+    while (true) {
+        if (!hasPendingInfo()) {
+            while (!hasLogs() && isLogRunning_.load()) co_await logReady_.wait(*scheduler_);
+
+            const auto lazyDeadline = std::chrono::steady_clock::now() + LOG_LAZY_DELAY;
+            while (!hasLogs(true) && !isInfoChunkReady() && isLogRunning_.load()) {
+                const auto left = lazyDeadline - std::chrono::steady_clock::now();
+                if (left <= left.zero() || !co_await logReady_.wait(*scheduler_, left)) break;
+            }
+        }
+
+        // флаг - до того, как забрать полосы: всё, что записано до остановки, окажется в пачках
+        const bool isRunning = isLogRunning_.load();
+        if (takeLogs() == 0 && !hasPendingInfo()) {
+            if (!isRunning && closeLogNodes()) break;  // остановлен и всё записано
+            continue;
+        }
+
+        for (const LogLevel level : {ERROR, WARNING}) {
+            for (auto& node : logNodes_) {
+                writeLane(*node, level, node->batches[level].data(), node->batches[level].size());
+                node->batches[level].clear();
+            }
+        }
+        for (auto& node : logNodes_) {
+            const size_t count = std::min(node->batches[INFO].size() - node->infoPosition, LOG_LANE_CHUNK);
+            writeLane(*node, INFO, node->batches[INFO].data() + node->infoPosition, count);
+            node->infoPosition += count;
+        }
+        if (hasPendingInfo()) co_await scheduler_->yield();
+    }
+
+    const char* laneNames[LOG_LANE_COUNT] = {"INFO", "WARNING", "ERROR"};
+    for (const LogLevel level : {INFO, WARNING, ERROR}) {
+        const LogLaneStats stats = getLogLaneStats(level);
+        appLog_->logEvent(LogEvent("APP", "lane {}: {} dropped, latency p99 {}, max {}.",
+                                   {stringField("lane", laneNames[level]),
+                                    intField("dropped", static_cast<int64_t>(stats.dropped)),
+                                    durationField("p99", stats.p99Latency), durationField("max", stats.maxLatency)}));
+    }
 }
 
-void MultithreadAppManager::logMulti() {
-    // работаем с записью сообщений в журнал через очередь, а также условную переменную
-    // еще используем мьютекс для очереди
-    app->writeLog("APP | START THREAD logMulti");
-    while (logThreadRunning_.load() || !logQueue_.empty()) {
-        std::unique_lock<std::mutex> lock(logQueueMutex_);
+bool MultithreadAppManager::hasLogs(bool isUrgentOnly) {
+    for (auto& node : logNodes_) {
+        std::lock_guard<std::mutex> lock(node->mutex);
+        for (size_t level = isUrgentOnly ? WARNING : INFO; level != LOG_LANE_COUNT; ++level) {
+            if (node->lanes[level].queue.size() != node->lanes[level].head) return true;
+        }
+    }
+    return false;
+}
 
-        logCondVar_.wait_for(lock, std::chrono::milliseconds(100),
-                             [this]() { return !logQueue_.empty() || !logThreadRunning_.load(); });
+bool MultithreadAppManager::isInfoChunkReady() {
+    size_t count = 0;
+    for (auto& node : logNodes_) {
+        std::lock_guard<std::mutex> lock(node->mutex);
+        count += node->lanes[INFO].queue.size() - node->lanes[INFO].head;
+    }
+    return count >= LOG_LANE_CHUNK;
+}
 
-        while (!logQueue_.empty()) {
-            const auto& logMessage = logQueue_.front();
-            logger_->log(logMessage.first, logMessage.second);
-            logQueue_.pop();
+size_t MultithreadAppManager::takeLogs() {
+    // старая пачка INFO узла, пока не дописана, остается, а срочные забираются всегда
+    size_t taken = 0;
+    for (auto& node : logNodes_) {
+        {
+            std::lock_guard<std::mutex> lock(node->mutex);
+            for (size_t level = 0; level != LOG_LANE_COUNT; ++level) {
+                if (level == INFO && node->infoPosition != node->batches[INFO].size()) continue;
+                LogLane&               lane  = node->lanes[level];
+                std::vector<LogSlot*>& batch = node->batches[level];
+                batch.clear();
+                std::swap(batch, lane.queue);
+                batch.erase(batch.begin(), batch.begin() + lane.head);
+                lane.head = 0;
+                taken += batch.size();
+                if (level == INFO) node->infoPosition = 0;
+            }
         }
+        node->spaceCondVar.notify_all();
+    }
+    return taken;
+}
+
+bool MultithreadAppManager::closeLogNodes() {
+    // узел закрывается под своим мьютексом и только пустым: запись, которую производитель положил
+    // между takeLogs и закрытием, задача заберет на следующем проходе
+    bool isEmpty = true;
+    for (auto& node : logNodes_) {
+        std::lock_guard<std::mutex> lock(node->mutex);
+        for (const LogLane& lane : node->lanes) isEmpty = isEmpty && lane.queue.size() == lane.head;
+        node->isClosed = isEmpty;
+        if (!isEmpty) break;
+    }
+    return isEmpty;
+}
 
-        lock.unlock();
+bool MultithreadAppManager::hasPendingInfo() const {
+    for (const auto& node : logNodes_) {
+        if (node->infoPosition != node->batches[INFO].size()) return true;
     }
+    return false;
 }
 
-void MultithreadAppManager::writeLog(const std::string& message, LogLevel logLevel) {
-    logQueue_.push({message, logLevel});
+LogNode& MultithreadAppManager::getLogNode() {
+    if (logNodes_.size() == 1) return *logNodes_[0];
+    return *logNodes_[std::min(static_cast<size_t>(getCurrentNode()), logNodes_.size() - 1)];
+}
+
+void MultithreadAppManager::writeLane(LogNode& node, LogLevel logLevel, LogSlot* const* slots, size_t count) {
+    if (count == 0) return;
+
+    // записи ссылаются на текст прямо в ячейках пула, ячейки возвращаются в пул после записи
+    size_t longCount = 0;
+    for (size_t i = 0; i != count; ++i) longCount += slots[i]->size > LOG_SLOT_TEXT_SIZE;
+    if (longTexts_.size() < longCount) longTexts_.resize(longCount);
+
+    longCount = 0;
+    logRecords_.clear();
+    for (size_t i = 0; i != count; ++i) {
+        const LogSlot*   slot = slots[i];
+        std::string_view message(slot->text, slot->size);
+        if (slot->size > LOG_SLOT_TEXT_SIZE) message = node.recordPool.getText(*slot, longTexts_[longCount++]);
+        logRecords_.push_back({message, slot->event, slot->logLevel, slot->ticks});
+    }
+    logger_->logBatch(logRecords_.data(), logRecords_.size(), logLevel != INFO);
+
+    // задержка - от очереди до записи в файл, в корзины по степеням двойки
+    LogLane&        lane  = node.lanes[logLevel];
+    const LogClock& clock = logger_->getClock();
+    const uint64_t  now   = clock.now();
+    for (size_t i = 0; i != count; ++i) {
+        const int64_t latency = std::max<int64_t>(clock.toNanoseconds(now - slots[i]->ticks), 1);
+        ++lane.latency[63 - __builtin_clzll(static_cast<uint64_t>(latency))];
+        lane.maxLatency = std::max(lane.maxLatency, latency);
+        node.recordPool.release(slots[i]);
+    }
+    lane.written += count;
+}
+
+void MultithreadAppManager::pushLog(LogComponent& component, std::string_view message, const LogEvent& event,
+                                    LogLevel logLevel) {
+    // пул исчерпан только если задача журнала безнадежно отстала: тогда пишем сами, в обход очереди
+    LogNode& node = getLogNode();
+    LogSlot* slot = node.recordPool.acquire(message, event, logLevel);
+    if (slot == nullptr) {
+        if (event.name != nullptr)
+            component.writeEvent(event, logLevel);
+        else
+            component.write(std::string(message), logLevel);
+        return;
+    }
+
+    // время события - до мьютекса: одно чтение TSC, в календарь его переведет задача журнала
+    slot->ticks   = logger_->getClock().now();
+    LogLane& lane = node.lanes[logLevel];
+    bool     shouldWake, isDirect = false;
+    {
+        std::unique_lock<std::mutex> lock(node.mutex);
+        if (lane.queue.size() - lane.head >= lane.capacity && isLogRunning_.load()) {
+            if (lane.dropPolicy == LANE_DROP_NEWEST) {
+                ++lane.dropped;
+                lock.unlock();
+                node.recordPool.release(slot);
+                return;
+            }
+            if (lane.dropPolicy == LANE_DROP_OLDEST) {
+                ++lane.dropped;
+                node.recordPool.release(lane.queue[lane.head++]);
+            } else if (TaskScheduler::isWorkerThread()) {
+                isDirect = true;  // рабочий поток ждать не может: задача журнала могла достаться ему же
+            } else {
+                node.spaceCondVar.wait(lock, [this, &lane]() {
+                    return lane.queue.size() - lane.head < lane.capacity || !isLogRunning_.load();
+                });
+            }
+        }
+
+        // пока задача журнала читает узел, запись идет в полосу и после остановки: так она не обгонит
+        // записи, которые уже ждут. в закрытом узле она бы пропала
+        isDirect = isDirect || node.isClosed;
+        if (!isDirect) {
+            lane.queue.push_back(slot);
+            // INFO будит задачу журнала только полной пачкой, остальное она заберет сама через LOG_LAZY_DELAY
+            shouldWake =
+                logLevel != INFO || lane.queue.size() - lane.head == LOG_LANE_CHUNK || lane.queue.size() == 1;
+        }
+    }
+
+    if (isDirect) {  // пишем сами, в обход очереди
+        node.recordPool.release(slot);
+        if (event.name != nullptr)
+            component.writeEvent(event, logLevel);
+        else
+            component.write(std::string(message), logLevel);
+        return;
+    }
+    if (shouldWake) logReady_.notify();
+}
+
+void MultithreadAppManager::writeLog(std::string_view message, LogLevel logLevel) {
+    writeLog(*appLog_, message, logLevel);
+}
+
+void MultithreadAppManager::writeLog(LogComponent& component, std::string_view message, LogLevel logLevel) {
+    // в самописец попадает всё, а отфильтрованное сообщение даже не попадает в очередь
+    component.record(message, logLevel);
+    if (!component.isEnabled(logLevel)) return;
+    pushLog(component, message, LogEvent(), logLevel);
+}
+
+void MultithreadAppManager::writeEvent(LogComponent& component, const LogEvent& event, LogLevel logLevel) {
+    component.record(event, logLevel);
+    if (!component.isEnabled(logLevel)) return;
+    pushLog(component, std::string_view(), event, logLevel);
 }
 
 void MultithreadAppManager::stopLogging() {
-    // через атомарную переменную завершаем поток записи в журнал
+    // задача журнала допишет очереди и завершится
     // уведомляем всем, что закончили
-    app->writeLog("APP | END THREAD logMulti");
-    logThreadRunning_.store(false);
-    logCondVar_.notify_all();
+    writeLog("APP | END TASK writeLogs");
+    isLogRunning_ = false;
+    for (auto& node : logNodes_) {
+        std::lock_guard<std::mutex> lock(node->mutex);  // ждущий производитель не пропустит уведомление
+        node->spaceCondVar.notify_all();
+    }
+    logReady_.notify();
+}
+
+bool MultithreadAppManager::isMazeGenerated() const { return isMazeGenerated_.load(); }
+
+TaskWaitAwaiter MultithreadAppManager::waitMazeGenerated(std::chrono::milliseconds timeout) {
+    return mazeReady_.wait(*scheduler_, timeout);
+}
+
+void MultithreadAppManager::markPlayable() {
+    const auto latency = std::chrono::steady_clock::now() - startTime_;
+    playableLatency_.store(std::chrono::duration_cast<std::chrono::nanoseconds>(latency).count());
+    writeEvent(*appLog_, LogEvent("APP", "playable {} seconds after start.",
+                                  {durationField("latency", latency)}));
 }
 
-bool MultithreadAppManager::isMazeGenerated() const { return mazeGeneratedThread_.load(); }
\ No newline at end of file
+std::chrono::nanoseconds MultithreadAppManager::getPlayableLatency() const {
+    return std::chrono::nanoseconds(playableLatency_.load());
+}
\ No newline at end of file
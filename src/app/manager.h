@@ -3,44 +3,136 @@
 #include <logger/logger.h>
 
 #include <atomic>
+#include <chrono>
 #include <condition_variable>
 #include <memory>
 #include <mutex>
-#include <queue>
-#include <thread>
+#include <string_view>
 #include <utility>
+#include <vector>
 
 #include "game.h"
+#include "mazepack.h"
 #include "player.h"
+#include "recordpool.h"
+#include "scheduler.h"
+#include "session.h"
+
+// у каждого уровня важности своя очередь (полоса): задача журнала сначала пишет ERROR и WARNING и сразу
+// сбрасывает их в файл, а INFO копит пачками и пишет частями, так что ошибка не ждет за тысячами ходов.
+// генерация лабиринта, игра и журнал - задачи на общих рабочих потоках планировщика, а не три своих потока.
+// на машине с несколькими узлами NUMA у каждого узла свои полосы, мьютекс и ячейки, и создается узел потоком
+// на его процессорах: производитель пишет в память своего узла, а между сокетами ходит только задача журнала
+
+constexpr size_t LOG_LANE_COUNT    = 3;      // INFO, WARNING, ERROR
+constexpr size_t LOG_LANE_CAPACITY = 65536;  // записей в полосе по умолчанию
+constexpr size_t LOG_LANE_CHUNK    = 256;    // INFO за один проход и размер пачки, ради которой стоит проснуться
+constexpr auto   LOG_LAZY_DELAY    = std::chrono::milliseconds(5);  // сколько INFO может ждать неполной пачки
+constexpr size_t LOG_BENCH_RECORDS = 100000;  // записей на производителя в runLogBenchmark по умолчанию
+
+enum LaneDropPolicy { LANE_BLOCK, LANE_DROP_NEWEST, LANE_DROP_OLDEST };  // что делать с полной полосой
+
+struct LogLaneStats {  // итог полосы
+    size_t                   written;     // записано в журнал
+    size_t                   dropped;     // отброшено из-за переполнения
+    std::chrono::nanoseconds p99Latency;  // от очереди до файла, с точностью до степени двойки
+    std::chrono::nanoseconds maxLatency;  // худшая задержка
+};
+
+struct LogLane {  // очередь сообщений одного уровня важности
+    std::vector<LogSlot*> queue;        // под мьютексом узла, забирается целиком
+    size_t                head;         // под мьютексом узла: начало очереди, LANE_DROP_OLDEST сдвигает его
+    size_t                capacity;     // сколько записей может ждать
+    LaneDropPolicy        dropPolicy;   // что делать при переполнении
+    size_t                dropped;      // под мьютексом узла
+    size_t                written;      // дальше - только задача журнала
+    size_t                latency[64];  // сколько записей ждали от 2^i до 2^(i+1) наносекунд
+    int64_t               maxLatency;   // наносекунды
+};
+
+struct LogNode {  // очереди одного узла NUMA
+    std::mutex              mutex;                    // для полос узла
+    std::condition_variable spaceCondVar;             // будит производителей, ждущих места в полосе
+    LogLane                 lanes[LOG_LANE_COUNT];    // очереди по уровням важности
+    LogRecordPool           recordPool;               // ячейки записей: растет на потоках узла, там и память
+    std::vector<LogSlot*>   batches[LOG_LANE_COUNT];  // задача журнала: забранные полосы
+    size_t                  infoPosition;             // задача журнала: сколько INFO из пачки уже записано
+    bool                    isClosed;                 // под мьютексом: задача журнала узел больше не читает
+};
+
+struct LogBenchmarkReport {  // итог runLogBenchmark
+    size_t                   records;  // записей от всех производителей
+    std::chrono::nanoseconds elapsed;  // от запуска задач до последней записи в файле
+    LogLaneStats             info;     // задержки полосы INFO
+};
 
 class MultithreadAppManager {
    public:
     std::unique_ptr<Logger> logger_;  // библиотека
    private:
-    std::unique_ptr<GameField> gameField_;  // игровое поле
-    std::unique_ptr<Player>    player_;     // игрок
-
-    std::thread mazeGenerateThread_, gameThread_,
-        logThread_;  // потоки: для генерации лабиринта, игровой, запись в журнал
-    std::atomic<bool> logThreadRunning_,
-        mazeGeneratedThread_;  // для обеспечения потокобезопасности и остановки потоков
-    std::queue<std::pair<std::string, LogLevel>> logQueue_;  // для отправки сообщений
-    std::condition_variable logCondVar_;     // для обеспечения потокобезопасности
-    std::mutex              logQueueMutex_;  // для обеспечения потокобезопасности
-
-    void runGameMulti() const;  // запуск игрового потока
-    void logMulti();            // запуск потока записи в журнал
-    void stopLogging();         // остановка потока записи в журнал
-    void runMazeGenMulti();     // запуск потока генерации лабиринта
-    void stopMazeGenerated();   // для остановки потока генерации лабиринта
+    LogComponent*                    appLog_;            // компонент "APP" для сообщений самого приложения
+    std::unique_ptr<GameField>       gameField_;         // игровое поле
+    std::unique_ptr<Player>          player_;            // игрок
+    std::unique_ptr<MazePack>        mazePack_;          // готовые лабиринты, если задан набор
+    std::unique_ptr<MazePool>        mazePool_;          // выдача из набора вместо генерации
+    std::unique_ptr<SessionRecorder> sessionRecorder_;   // запись игры для воспроизведения, если задана
+    bool                             rawInput_;          // посимвольный ввод без Enter
+    double                           mazeMutationRate_;  // изменений лабиринта в секунду, 0 - лабиринт неизменен
+
+    std::unique_ptr<TaskScheduler>        scheduler_;         // рабочие потоки для задач приложения
+    std::atomic<bool>                     isLogRunning_;      // для остановки задачи журнала
+    std::atomic<bool>                     isMazeGenerated_;   // лабиринт готов
+    TaskEvent                             mazeReady_;         // будит игру, ждущую лабиринт
+    TaskEvent                             logReady_;          // будит задачу журнала только при новых сообщениях
+    std::chrono::steady_clock::time_point startTime_;         // начало run, от него считаем задержку старта
+    std::atomic<int64_t>                  playableLatency_;   // от run до начала игры, наносекунды (-1 - еще нет)
+    std::vector<std::unique_ptr<LogNode>> logNodes_;          // очереди по узлам NUMA, на одном узле - одна
+    std::vector<LogRecord>                logRecords_;        // задача журнала: записи для logBatch
+    std::vector<std::string>              longTexts_;         // задача журнала: длинные тексты из цепочек ячеек
+
+    Task<>   generateMaze();  // задача генерации лабиринта
+    Task<>   playGame();      // игровая задача
+    Task<>   writeLogs();     // задача записи в журнал
+    Task<>   produceLogs(size_t recordCount, std::shared_ptr<std::atomic<size_t>> producersLeft);  // для бенчмарка
+    bool     hasLogs(bool isUrgentOnly = false);  // в полосах любого узла есть сообщения (только WARNING и ERROR)
+    bool     isInfoChunkReady();                  // INFO всех узлов набралось на пачку
+    size_t   takeLogs();                          // забрать полосы всех узлов, вернуть число новых записей
+    bool     hasPendingInfo() const;              // INFO из забранных пачек записаны не все
+    bool     closeLogNodes();                     // закрыть пустые узлы, false - где-то еще есть записи
+    LogNode& getLogNode();                        // очереди узла, на котором выполняется поток
+    void     writeLane(LogNode& node, LogLevel logLevel, LogSlot* const* slots,
+                       size_t count);  // записать и вернуть ячейки в пул узла
+    void     stopLogging();            // остановка задачи записи в журнал
+    void     pushLog(LogComponent& component, std::string_view message, const LogEvent& event,
+                     LogLevel logLevel);  // в очередь с пробуждением задачи журнала
 
    public:
     MultithreadAppManager(const std::string& logFilename = "game_log.txt", LogLevel logLevel = INFO,
-                          LogType logType = SAFELY);
+                          LogType logType = SAFELY, LogClockSource clockSource = LOG_CLOCK_TSC);
 
-    void writeLog(const std::string& message, LogLevel logLevel = INFO);  // записать сообщение в журнал
-    void run();                                                           // запуск приложения
-    bool isMazeGenerated() const;  // для отслеживания работы потока генерации лабиринта
+    void writeLog(std::string_view message, LogLevel logLevel = INFO);  // записать сообщение в журнал
+    void writeLog(LogComponent& component, std::string_view message,
+                  LogLevel logLevel = INFO);  // записать сообщение от имени компонента
+    void writeEvent(LogComponent& component, const LogEvent& event,
+                    LogLevel logLevel = INFO);  // записать событие, в строку оно превратится в задаче журнала
+    void useMazePack(const std::string& filename);                    // брать лабиринт из набора, до run
+    void recordSession(const std::string& filename);                  // записывать игру в файл, до run
+    SessionRecorder* getSessionRecorder() const;                      // nullptr, если игра не записывается
+    void useRawInput();                                               // посимвольный ввод в игре, до run
+    bool isRawInput() const;                                          // включен ли посимвольный ввод
+    void useDynamicMaze(double changesPerSecond);                     // блоки меняются во время игры, до run
+    double getMazeMutationRate() const;                               // изменений в секунду, 0 - выключено
+    void configureLogLane(LogLevel logLevel, size_t capacity, LaneDropPolicy dropPolicy);  // до run
+    LogLaneStats getLogLaneStats(LogLevel logLevel) const;  // задержки и потери полосы, после run
+    void useWorkers(size_t workerCount);                              // рабочих потоков для задач, до run
+    void pinWorkers(const std::vector<int>& cpus);                    // рабочий i - на cpus[i % size], до run
+    TaskScheduler& getScheduler();                                    // планировщик задач приложения
+    void run();                                                       // запуск приложения
+    LogBenchmarkReport runLogBenchmark(size_t producerCount, size_t recordCount);  // нагрузка на очереди журнала
+    bool isMazeGenerated() const;  // для отслеживания работы задачи генерации лабиринта
+    TaskWaitAwaiter waitMazeGenerated(std::chrono::milliseconds timeout);  // co_await: лабиринт готов до timeout
+    void markPlayable();                                  // игра началась: записать задержку старта
+    std::chrono::nanoseconds getPlayableLatency() const;  // от run до начала игры, -1 - еще нет
 };
 
 extern std::unique_ptr<MultithreadAppManager> app;  // само приложение
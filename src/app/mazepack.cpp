@@ -0,0 +1,178 @@
+#include "mazepack.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+size_t getMazeRecordSize() {
+    const size_t cellsSize = (static_cast<size_t>(ROWS * COLUMNS) + 7) / 8;
+    return (sizeof(MazeInfo) + cellsSize + 7) / 8 * 8;
+}
+
+MazeInfo encodeMaze(uint32_t seed, std::vector<uint8_t>& record) {
+    // генерация одного лабиринта сразу в формат записи набора
+    GameField gameField(ROWS, COLUMNS);
+    MazeInfo  info{};
+    info.seed           = seed;
+    info.attempts       = static_cast<uint16_t>(gameField.generate(seed));
+    info.solutionLength = gameField.getDistance(GAME_BEGIN);
+
+    record.assign(getMazeRecordSize(), 0);
+    std::memcpy(record.data(), &info, sizeof(info));
+    gameField.saveCells(record.data() + sizeof(info));
+    return info;
+}
+
+MazeInfo decodeMaze(const uint8_t* record, GameField& gameField) {
+    MazeInfo info;
+    std::memcpy(&info, record, sizeof(info));
+    gameField.loadCells(record + sizeof(info), info.seed);
+    return info;
+}
+
+void writeMazePack(const std::string& filename, uint32_t count, uint32_t firstSeed) {
+    std::ofstream packFile(filename, std::ios::binary | std::ios::trunc);
+    if (!packFile.is_open()) throw std::runtime_error("Error: creating maze pack!");
+
+    MazePackHeader header{};
+    std::memcpy(header.magic, MAZE_PACK_MAGIC, sizeof(header.magic));
+    header.version    = MAZE_PACK_VERSION;
+    header.rows       = ROWS;
+    header.columns    = COLUMNS;
+    header.count      = count;
+    header.recordSize = static_cast<uint32_t>(getMazeRecordSize());
+    packFile.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    // лабиринты независимы, поэтому генерируем их на всех ядрах, каждый поток - свою часть записей
+    const size_t             recordSize = getMazeRecordSize();
+    std::vector<uint8_t>     records(static_cast<size_t>(count) * recordSize);
+    std::vector<std::thread> workers;
+    const uint32_t           workerCount = std::max(1u, std::thread::hardware_concurrency());
+    for (uint32_t worker = 0; worker != workerCount; ++worker) {
+        workers.emplace_back([&, worker]() {
+            std::vector<uint8_t> record;
+            for (uint32_t i = worker; i < count; i += workerCount) {
+                encodeMaze(firstSeed + i, record);
+                std::memcpy(records.data() + i * recordSize, record.data(), recordSize);
+            }
+        });
+    }
+    for (auto& worker : workers) worker.join();
+
+    packFile.write(reinterpret_cast<const char*>(records.data()), static_cast<std::streamsize>(records.size()));
+
+    if (!packFile.good()) throw std::runtime_error("Error: writing maze pack!");
+}
+
+MazePack::MazePack(const std::string& filename) : data_(nullptr), size_(0), header_() {
+    const int fd = open(filename.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) throw std::runtime_error("Error: opening maze pack!");
+
+    struct stat fileStat {};
+    if (fstat(fd, &fileStat) != 0 || static_cast<size_t>(fileStat.st_size) < sizeof(MazePackHeader)) {
+        close(fd);
+        throw std::runtime_error("Error: maze pack is too small!");
+    }
+
+    size_ = static_cast<size_t>(fileStat.st_size);
+    void* mapped = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapped == MAP_FAILED) throw std::runtime_error("Error: mapping maze pack!");
+    data_ = static_cast<const uint8_t*>(mapped);
+
+    std::memcpy(&header_, data_, sizeof(header_));
+    const bool isValid = std::memcmp(header_.magic, MAZE_PACK_MAGIC, sizeof(header_.magic)) == 0 &&
+                         header_.version == MAZE_PACK_VERSION && header_.rows == ROWS && header_.columns == COLUMNS &&
+                         header_.recordSize == getMazeRecordSize() &&
+                         size_ >= sizeof(header_) + static_cast<size_t>(header_.count) * header_.recordSize;
+    if (!isValid) {
+        munmap(const_cast<uint8_t*>(data_), size_);
+        throw std::runtime_error("Error: invalid maze pack!");
+    }
+
+    // лабиринты берутся вразнобой, поэтому читать заранее нечего
+    madvise(const_cast<uint8_t*>(data_), size_, MADV_RANDOM);
+}
+
+MazePack::~MazePack() { munmap(const_cast<uint8_t*>(data_), size_); }
+
+size_t MazePack::getCount() const { return header_.count; }
+
+MazeInfo MazePack::load(size_t index, GameField& gameField) const {
+    if (index >= header_.count) throw std::out_of_range("Error: maze index out of range!");
+    return decodeMaze(data_ + sizeof(header_) + index * header_.recordSize, gameField);
+}
+
+MazePool::MazePool(const MazePack* pack, size_t capacity, size_t packStart, uint32_t firstSeed)
+    : pack_(pack),
+      packStart_(packStart),
+      packTaken_(0),
+      capacity_(capacity),
+      nextSeed_(firstSeed),
+      isStopped_(false),
+      refillThread_([this]() { refill(); }) {}
+
+MazePool::~MazePool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        isStopped_ = true;
+    }
+    refillCondVar_.notify_all();
+    refillThread_.join();
+}
+
+size_t MazePool::getPackRemaining() const {
+    const size_t count = pack_ != nullptr ? pack_->getCount() : 0, taken = packTaken_.load();
+    return taken < count ? count - taken : 0;
+}
+
+void MazePool::refill() {
+    // генерируем, только когда запас (остаток набора и готовые) меньше capacity_:
+    // пока набор большой, фоновый поток спит
+    std::vector<uint8_t> record;
+    while (true) {
+        uint32_t seed;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            refillCondVar_.wait(lock,
+                                [this]() { return isStopped_ || getPackRemaining() + ready_.size() < capacity_; });
+            if (isStopped_) return;
+            seed = nextSeed_++;
+        }
+
+        encodeMaze(seed, record);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            ready_.push(std::move(record));
+        }
+        readyCondVar_.notify_one();
+    }
+}
+
+MazeInfo MazePool::take(GameField& gameField) {
+    const size_t taken = packTaken_.fetch_add(1);
+    if (pack_ != nullptr && taken < pack_->getCount()) {
+        const MazeInfo info = pack_->load((packStart_ + taken) % pack_->getCount(), gameField);
+        { std::lock_guard<std::mutex> lock(mutex_); }  // чтобы фоновый поток не пропустил пробуждение
+        refillCondVar_.notify_one();
+        return info;
+    }
+
+    std::vector<uint8_t> record;
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        readyCondVar_.wait(lock, [this]() { return !ready_.empty(); });
+        record = std::move(ready_.front());
+        ready_.pop();
+    }
+    refillCondVar_.notify_one();
+
+    return decodeMaze(record.data(), gameField);
+}
\ No newline at end of file
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "game.h"
+
+// набор заранее сгенерированных лабиринтов:
+//   MazePackHeader, затем count записей по recordSize байт.
+//   запись: MazeInfo (8 байт) и клетки GameField::saveCells, дополненные до кратного 8
+
+constexpr char     MAZE_PACK_MAGIC[4] = {'M', 'Z', 'P', 'K'};
+constexpr uint32_t MAZE_PACK_VERSION  = 1;
+
+struct MazePackHeader {
+    char     magic[4];    // MZPK
+    uint32_t version;     // версия формата
+    uint16_t rows;        // размеры поля
+    uint16_t columns;     // (должны совпадать с ROWS и COLUMNS)
+    uint32_t count;       // количество лабиринтов
+    uint32_t recordSize;  // байт на лабиринт
+    uint32_t reserved;    // выравнивание до 24 байт
+};
+
+struct MazeInfo {
+    uint32_t seed;            // зерно, из которого лабиринт сгенерирован
+    uint16_t attempts;        // сколько попыток понадобилось генерации
+    uint16_t solutionLength;  // оптимальное число ходов от старта до финиша
+};
+
+size_t getMazeRecordSize();  // размер записи для поля ROWS x COLUMNS
+void   writeMazePack(const std::string& filename, uint32_t count, uint32_t firstSeed = 1);  // сгенерировать набор
+
+class MazePack {  // набор лабиринтов, отображенный в память: загрузка - копирование бит, без генерации
+   private:
+    const uint8_t* data_;    // отображение файла
+    size_t         size_;    // размер файла
+    MazePackHeader header_;  // заголовок
+
+   public:
+    explicit MazePack(const std::string& filename);
+    ~MazePack();
+    MazePack(const MazePack&)            = delete;
+    MazePack& operator=(const MazePack&) = delete;
+
+    size_t   getCount() const;                                // количество лабиринтов
+    MazeInfo load(size_t index, GameField& gameField) const;  // заполнить поле лабиринтом index
+};
+
+class MazePool {  // выдача готовых лабиринтов: сначала из набора, затем из фонового потока
+   private:
+    const MazePack*                  pack_;           // набор, может быть nullptr
+    size_t                           packStart_;      // с какого лабиринта набора начинать
+    std::atomic<size_t>              packTaken_;      // сколько лабиринтов набора выдано
+    size_t                           capacity_;       // сколько готовых лабиринтов держать в запасе
+    uint32_t                         nextSeed_;       // зерно для следующей генерации
+    bool                             isStopped_;      // для остановки фонового потока
+    std::queue<std::vector<uint8_t>> ready_;          // сгенерированные записи в формате набора
+    std::mutex                       mutex_;          // для ready_, nextSeed_ и isStopped_
+    std::condition_variable          refillCondVar_;  // будит фоновый поток, когда запас уменьшился
+    std::condition_variable          readyCondVar_;   // будит ожидающих готовый лабиринт
+    std::thread                      refillThread_;   // фоновая генерация
+
+    size_t getPackRemaining() const;  // сколько лабиринтов набора еще не выдано
+    void   refill();                  // цикл фонового потока
+
+   public:
+    MazePool(const MazePack* pack, size_t capacity = 4, size_t packStart = 0, uint32_t firstSeed = 1);
+    ~MazePool();
+
+    MazeInfo take(GameField& gameField);  // заполнить поле готовым лабиринтом
+};
\ No newline at end of file
@@ -1,5 +1,9 @@
 #include "player.h"
 
+#include <unistd.h>
+
+#include <fstream>
+
 #include "manager.h"
 
 LogLevel parseLogLevelStringWithDefault(const std::string& logLevel, LogLevel defaultForLog) {
@@ -13,86 +17,93 @@ LogLevel parseLogLevelStringWithDefault(const std::string& logLevel, LogLevel de
         return defaultForLog;
 }
 
-void Player::processMove(char move, const std::string& logLevel) {
+int parseMoveLevel(const std::string& logLevel) {  // для записи игры: -1, если уровень не указан
+    if (logLevel != "INFO" && logLevel != "WARNING" && logLevel != "ERROR") return -1;
+    return parseLogLevelStringWithDefault(logLevel, INFO);
+}
+
+Task<> Player::processMove(char move, const std::string& logLevel) {
     // обрабатываем движение: смотрим, можно ли ходить игроку
-    app->writeLog("Player::processMove | data = " + std::string(1, move),
-                  parseLogLevelStringWithDefault(logLevel, INFO));
-    Position newPosition    = position_;
-    bool     moveSuccessful = false;
+    // если игра записывается, ход попадает в запись вместе с уровнями
+    SessionRecorder* recorder  = app->getSessionRecorder();
+    const int        moveLevel = parseMoveLevel(logLevel);
 
-    switch (tolower(move)) {
-        case '1':
-            printAboutChangingDLL();
-            processDLL();
-            break;
-        case 'w':
-            if (newPosition.x - 1 >= 0 && gameField_->isWalkable(newPosition.x - 1, newPosition.y)) {
-                --newPosition.x;
-                moveSuccessful = true;
-                app->writeLog("Player::processMove | moving up. New coordinates: " + std::to_string(newPosition.y) +
-                                  ';' + std::to_string(newPosition.x),
-                              parseLogLevelStringWithDefault(logLevel, INFO));
-            } else {
-                app->writeLog("Player::processMove | failed to move up.",
-                              parseLogLevelStringWithDefault(logLevel, WARNING));
-            }
-            break;
-        case 's':
-            if (newPosition.x + 1 < ROWS && gameField_->isWalkable(newPosition.x + 1, newPosition.y)) {
-                ++newPosition.x;
-                moveSuccessful = true;
-                app->writeLog("Player::processMove | moving down. New coordinates: " + std::to_string(newPosition.y) +
-                                  ';' + std::to_string(newPosition.x),
-                              parseLogLevelStringWithDefault(logLevel, INFO));
-            } else {
-                app->writeLog("Player::processMove | failed to move down.",
-                              parseLogLevelStringWithDefault(logLevel, WARNING));
-            }
-            break;
-        case 'a':
-            if (newPosition.y - 1 >= 0 && gameField_->isWalkable(newPosition.x, newPosition.y - 1)) {
-                --newPosition.y;
-                moveSuccessful = true;
-                app->writeLog("Player::processMove | moving left. New coordinates: " + std::to_string(newPosition.y) +
-                                  ';' + std::to_string(newPosition.x),
-                              parseLogLevelStringWithDefault(logLevel, INFO));
-            } else {
-                app->writeLog("Player::processMove | failed to move left.",
-                              parseLogLevelStringWithDefault(logLevel, WARNING));
-            }
-            break;
-        case 'd':
-            if (newPosition.y + 1 < COLUMNS && gameField_->isWalkable(newPosition.x, newPosition.y + 1)) {
-                ++newPosition.y;
-                moveSuccessful = true;
-                app->writeLog("Player::processMove | moving right. New coordinates: " + std::to_string(newPosition.y) +
-                                  ';' + std::to_string(newPosition.x),
-                              parseLogLevelStringWithDefault(logLevel, INFO));
-            } else {
-                app->writeLog("Player::processMove | failed to move right.",
-                              parseLogLevelStringWithDefault(logLevel, WARNING));
-            }
-            break;
-        default:
-            std::cout << "Unknown movement! Please enter the correct data.\n";
-            std::this_thread::sleep_for(std::chrono::milliseconds(500));
-            app->writeLog("Player::processMove | incorrect data = " + std::to_string(move),
-                          parseLogLevelStringWithDefault(logLevel, ERROR));
-            return;
+    app->writeEvent(*logComponent_, LogEvent("Player::processMove", "data = {}", {charField("data", move)}),
+                    parseLogLevelStringWithDefault(logLevel, INFO));
+    if (move == '1') {
+        printAboutChangingDLL();
+        const int chosenLevel = co_await processDLL();
+        if (recorder != nullptr) recorder->record(move, moveLevel, chosenLevel);
+        co_return;
+    }
+
+    if (recorder != nullptr) recorder->record(move, moveLevel);
+
+    const MoveDirection* direction = findMoveDirection(move);
+    if (direction == nullptr) {
+        co_await showNotice("Unknown movement! Please enter the correct data.\n", std::chrono::milliseconds(500));
+        app->writeEvent(*logComponent_,
+                        LogEvent("Player::processMove", "incorrect data = {}", {intField("data", move)}),
+                        parseLogLevelStringWithDefault(logLevel, ERROR));
+        co_return;
     }
 
-    // если игрок все же сходил, то меняем его позицию, но сначала очистив
-    if (moveSuccessful) {
-        gameField_->clearPlayerPosition(position_);
-        position_ = newPosition;
-        gameField_->setPlayerPosition(position_);
+    // если игрок все же может сходить, то меняем его позицию, но сначала очистив
+    const Position newPosition = {position_.x + direction->offset.x, position_.y + direction->offset.y};
+    if (!gameField_->canMove(newPosition)) {
+        app->writeEvent(
+            *logComponent_,
+            LogEvent("Player::processMove", "failed to move {}.", {stringField("direction", direction->name)}),
+            parseLogLevelStringWithDefault(logLevel, WARNING));
+        co_return;
     }
+
+    app->writeEvent(*logComponent_,
+                    LogEvent("Player::processMove", "moving {}. New coordinates: {}",
+                             {stringField("direction", direction->name),
+                              pointField("position", newPosition.y, newPosition.x)}),
+                    parseLogLevelStringWithDefault(logLevel, INFO));
+
+    gameField_->clearPlayerPosition(position_);
+    position_ = newPosition;
+    gameField_->setPlayerPosition(position_);
 }
 
-Player::Player(GameField* gameField) : gameField_(gameField), position_(GAME_BEGIN) {}
+Player::Player(GameField* gameField, LogComponent& logComponent)
+    : gameField_(gameField), position_(GAME_BEGIN), logComponent_(&logComponent), input_(nullptr) {}
+
+Task<> Player::showNotice(const std::string& notice, std::chrono::milliseconds delay) const {
+    // в построчном режиме сообщение держится delay до перерисовки (рабочий поток тем временем свободен),
+    // в посимвольном - выводится под следующим кадром, чтобы не задерживать ввод
+    if (input_ != nullptr) {
+        notice_ += notice;
+        co_return;
+    }
+
+    std::cout << notice << std::flush;
+    co_await app->getScheduler().sleepFor(delay);
+}
+
+Task<> Player::waitInput() const {
+    // ждать готовности stdin можно, только если std::cin читает сам дескриптор (filebuf после
+    // sync_with_stdio(false)) и в его буфере пусто: подмененный буфер (тесты) уже в памяти
+    std::cout << std::flush;
+    std::streambuf* buffer = std::cin.rdbuf();
+    if (dynamic_cast<std::filebuf*>(buffer) == nullptr || buffer->in_avail() != 0) co_return;
+    co_await app->getScheduler().waitReadable(STDIN_FILENO);
+}
+
+Task<bool> Player::waitKeys(std::string& keys, int timeoutMs) const {
+    // поток InputReader кладет клавиши и будит через eventfd: его готовности ждет планировщик
+    if (!input_->waitKeys(keys, 0)) co_return false;
+    if (!keys.empty()) co_return true;
+
+    co_await app->getScheduler().waitReadable(input_->getWakeFd(), std::chrono::milliseconds(timeoutMs));
+    co_return input_->waitKeys(keys, 0);
+}
 
 void Player::printBeforePlay() const {
-    app->writeLog("Player::printBeforePlay | received information before starting.");
+    app->writeLog(*logComponent_, "Player::printBeforePlay | received information before starting.");
     std::cout << "Control keys:\n"
               << "\tW - up\n"
               << "\tA - left\n"
@@ -102,47 +113,54 @@ void Player::printBeforePlay() const {
     std::cout << "These messages will disappear!\n";
 }
 
-void Player::printWhileMazeGenerating() const {
-    // вывод крутящегося спиннера, чтобы пользователь не скучал, если поток генерации запаздывает
+Task<> Player::printWhileMazeGenerating() const {
+    // вывод крутящегося спиннера, чтобы пользователь не скучал, если генерация запаздывает
+    // ожидание на событии: как только лабиринт готов, игра начинается без задержки
     const std::string spinner = "/-\\|";
     int               idx     = 0;
 
-    while (!app->isMazeGenerated()) {  // атомарная переменная в помощь
+    while (!app->isMazeGenerated() && !co_await app->waitMazeGenerated(std::chrono::milliseconds(150))) {
         std::cout << "\rGenerating maze, please wait..." << spinner[idx++ % 4] << std::flush;
-        std::this_thread::sleep_for(std::chrono::milliseconds(150));
     }
 
     std::cout << std::endl << "Maze is ready! You can start the game now." << std::endl;
-    std::this_thread::sleep_for(std::chrono::seconds(2));
 }
 
-void Player::play() {
+Task<> Player::play() {
     // проверяем, достиг ли игрок финиша
     // высчитываем его время прохождения
     // также обрабатываем введенные клавиши необычным образом
     // это сделано ради работы тестов
-    printWhileMazeGenerating();
+    co_await printWhileMazeGenerating();
+    app->markPlayable();
+    if (app->getSessionRecorder() != nullptr)
+        app->getSessionRecorder()->start(gameField_->getSeed(), app->logger_->getLogLevel());
+    if (app->getMazeMutationRate() > 0) {
+        dynamicMaze_  = std::make_unique<DynamicMaze>(*gameField_, gameField_->getSeed());
+        lastMutation_ = std::chrono::steady_clock::now();
+    }
+
+    auto begin = std::chrono::high_resolution_clock::now();
+    if (app->isRawInput()) {
+        InputReader input(STDIN_FILENO);
+        input_ = &input;
+        co_await playRaw(begin);
+        input_ = nullptr;
+        co_return;
+    }
 
-    auto        begin = std::chrono::high_resolution_clock::now();
     char        move;
     std::string userInput;
     while (true) {
+        mutateMaze();
         gameField_->clearScreen();
         gameField_->display();
 
-        if (position_ == GAME_END) {
-            const auto end = std::chrono::high_resolution_clock::now();
-            std::cout << "Congratulations! You've reached the finish!\n";
-            gameDuration_ = end - begin;
-            std::cout << "Your time: " << gameDuration_.count() << " seconds!\n";
-
-            app->writeLog("Player::play | finished the game. Time = " + std::to_string(gameDuration_.count()) +
-                          " seconds.");
-            break;
-        }
+        if (checkFinish(begin)) break;
 
         if (std::cin.eof()) break;
 
+        co_await waitInput();
         std::getline(std::cin, userInput);
         if (userInput.empty()) continue;
 
@@ -150,7 +168,7 @@ void Player::play() {
         std::string logLevelStr = (userInput.size() > 2) ? userInput.substr(2) : "ANY";
 
         if (!std::cin.fail()) {
-            processMove(move, logLevelStr);
+            co_await processMove(move, logLevelStr);
         } else {
             break;
         }
@@ -159,15 +177,83 @@ void Player::play() {
     }
 }
 
+Task<> Player::playRaw(std::chrono::high_resolution_clock::time_point begin) {
+    // клавиши, нажатые за время кадра (зажатая клавиша, быстрый набор), обрабатываются подряд,
+    // а поле перерисовывается один раз на всю пачку
+    // в меняющемся лабиринте кадр перерисовывается и без нажатий, с частотой изменений
+    const double rate    = app->getMazeMutationRate();
+    const int    timeout = rate > 0 ? std::max(1, static_cast<int>(1000 / rate)) : -1;
+
+    std::string keys;
+    while (true) {
+        mutateMaze();
+        gameField_->clearScreen();
+        gameField_->display();
+        std::cout << notice_ << std::flush;
+        notice_.clear();
+
+        if (checkFinish(begin)) break;
+
+        keys.clear();
+        if (!co_await waitKeys(keys, timeout)) break;  // Ctrl-D или конец ввода
+
+        for (const char key : keys) {
+            co_await processMove(key, "ANY");
+            if (position_ == GAME_END) break;
+        }
+    }
+}
+
+void Player::mutateMaze() {
+    // изменений столько, сколько положено по частоте за прошедшее время;
+    // после долгого ожидания ввода - не больше, чем за секунду
+    if (dynamicMaze_ == nullptr) return;
+
+    const double rate    = app->getMazeMutationRate();
+    const auto   now     = std::chrono::steady_clock::now();
+    size_t       changes = static_cast<size_t>(std::chrono::duration<double>(now - lastMutation_).count() * rate);
+    if (changes == 0) return;
+
+    if (static_cast<double>(changes) > std::max(rate, 1.0)) {
+        changes       = static_cast<size_t>(std::max(rate, 1.0));
+        lastMutation_ = now;
+    } else {
+        lastMutation_ += std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::duration<double>(static_cast<double>(changes) / rate));
+    }
+
+    size_t changed = 0;
+    for (size_t i = 0; i != changes; ++i) changed += dynamicMaze_->mutate(position_) ? 1 : 0;
+    if (changed == 0) return;
+
+    app->writeEvent(*logComponent_, LogEvent("Player::mutateMaze", "{} cells changed.",
+                                             {intField("changes", static_cast<int64_t>(changed))}));
+}
+
+bool Player::checkFinish(std::chrono::high_resolution_clock::time_point begin) {
+    if (!(position_ == GAME_END)) return false;
+
+    const auto end = std::chrono::high_resolution_clock::now();
+    std::cout << "Congratulations! You've reached the finish!\n";
+    gameDuration_ = end - begin;
+    std::cout << "Your time: " << gameDuration_.count() << " seconds!\n";
+
+    app->writeEvent(*logComponent_,
+                    LogEvent("Player::play", "finished the game. Time = {} seconds.",
+                             {durationField("time", std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                                        gameDuration_))}));
+    return true;
+}
+
 void Player::readme() const {
-    app->writeLog("Player::readme | received instructions.");
+    app->writeLog(*logComponent_, "Player::readme | received instructions.");
     std::cout << "Welcome in a simple game! Before starting:\n"
               << "[0] - play\n"
               << "[1] - change default log level and play (also can do this while running)\n";
 }
 
 void Player::printAboutChangingDLL() const {
-    app->writeLog("Player::printAboutChangingDLL | received instructions.");
+    app->writeLog(*logComponent_, "Player::printAboutChangingDLL | received instructions.");
     std::cout << "Just select default log level, which you want:\n";
 
     std::string INFO = "[0] - INFO", WARNING = "[1] - WARNING", ERROR = "[2] - ERROR";
@@ -182,49 +268,57 @@ void Player::printAboutChangingDLL() const {
     std::cout << INFO << std::endl << WARNING << std::endl << ERROR << std::endl;
 }
 
-void Player::processDLL() const {
-    short level;
-    std::cin >> level;
+Task<int> Player::processDLL() const {
+    short level = -1;
+    if (input_ != nullptr) {
+        // в посимвольном режиме уровень - следующая нажатая цифра, остальное из пачки отбрасывается
+        std::string keys;
+        while (keys.empty() && co_await waitKeys(keys)) {}
+        if (!keys.empty()) level = static_cast<short>(keys[0] - '0');
+    } else {
+        co_await waitInput();
+        std::cin >> level;
+    }
 
     if (level > static_cast<int>(LogLevel::ERROR) || level < static_cast<int>(LogLevel::INFO)) {
-        std::cout << "Not accepted!\n";
-        std::this_thread::sleep_for(std::chrono::seconds(1));
-        return;
+        co_await showNotice("Not accepted!\n", std::chrono::seconds(1));
+        co_return -1;
     }
 
     app->logger_->changeLogLevel(static_cast<LogLevel>(level));
-    app->writeLog("Player::processDLL | changed default log level!");
-    std::cout << "Settings saved. Go play!\n";
-    std::this_thread::sleep_for(std::chrono::seconds(1));
+    app->writeLog(*logComponent_, "Player::processDLL | changed default log level!");
+    co_await showNotice("Settings saved. Go play!\n", std::chrono::seconds(1));
+    co_return level;
 }
 
-void Player::handleChoice(short choice) {
+Task<> Player::handleChoice(short choice) {
     // тут обрабатываем выбор игрока
-    app->writeLog("Player::handleChoice | data = " + std::to_string(choice));
+    app->writeEvent(*logComponent_, LogEvent("Player::handleChoice", "data = {}", {intField("data", choice)}));
     switch (choice) {
         case PLAY:
-            app->writeLog("Player::handleChoice | decided to play!");
+            app->writeLog(*logComponent_, "Player::handleChoice | decided to play!");
             printBeforePlay();
-            play();
+            co_await play();
             break;
         case CHANGE_DLL:
-            app->writeLog("Player::handleChoice | open menu to change default log level.");
+            app->writeLog(*logComponent_, "Player::handleChoice | open menu to change default log level.");
             printAboutChangingDLL();
-            processDLL();
-            handleChoice(Choice::PLAY);
+            co_await processDLL();
+            co_await handleChoice(Choice::PLAY);
             break;
         default:
-            app->writeLog("Player::handleChoice | selected something unclear...", LogLevel::ERROR);
+            app->writeLog(*logComponent_, "Player::handleChoice | selected something unclear...", LogLevel::ERROR);
             std::cout << "Unknown choice! Please enter the correct data.\n";
             break;
     }
 }
 
-void Player::letsgo() {
+Task<> Player::letsgo() {
     // поехали!
     readme();
     short choice;
+    co_await waitInput();
     std::cin >> choice;
 
-    handleChoice(choice);
+    co_await handleChoice(choice);
 }
\ No newline at end of file
@@ -2,29 +2,43 @@
 
 #include <chrono>
 #include <iostream>
+#include <memory>
 #include <string>
-#include <thread>
 
+#include "dynamicmaze.h"
 #include "game.h"
+#include "input.h"
 #include "position.h"
+#include "scheduler.h"
 
 class Player {
    private:
-    GameField*                    gameField_;     // игровое поле
-    Position                      position_;      // текущая позиция игрока
-    std::chrono::duration<double> gameDuration_;  // время прохождения карты
+    GameField*                            gameField_;     // игровое поле
+    Position                              position_;      // текущая позиция игрока
+    std::chrono::duration<double>         gameDuration_;  // время прохождения карты
+    LogComponent*                         logComponent_;  // компонент журнала "Player"
+    InputReader*                          input_;         // посимвольный ввод, nullptr - построчный через std::cin
+    mutable std::string                   notice_;        // сообщение под следующим кадром в посимвольном режиме
+    std::unique_ptr<DynamicMaze>          dynamicMaze_;   // меняющийся лабиринт, если включен
+    std::chrono::steady_clock::time_point lastMutation_;  // до какого момента изменения уже сделаны
 
-    void processMove(char move, const std::string& logLevel);  // обработка движения игрока
-    void play();                                               // старт
-    void printBeforePlay() const;                              // вывод предыгровой информации
-    void readme() const;                                       // инструкция, как играть
-    void handleChoice(short choice);                           // обработка выбора игрока
-    void printWhileMazeGenerating() const;  // вывод информации с ожиданием, пока поток генерации активен
-    void printAboutChangingDLL() const;  // вывод об изменении уровня по умолчанию
-    void processDLL() const;
+    Task<>     processMove(char move, const std::string& logLevel);  // обработка движения игрока
+    Task<>     play();                                               // старт
+    Task<>     playRaw(std::chrono::high_resolution_clock::time_point begin);  // игровой цикл посимвольного ввода
+    bool       checkFinish(std::chrono::high_resolution_clock::time_point begin);  // финиш: время в журнал и на экран
+    Task<>     showNotice(const std::string& notice, std::chrono::milliseconds delay) const;  // сообщение игроку
+    void       mutateMaze();  // изменения лабиринта, накопившиеся с прошлого кадра
+    Task<>     waitInput() const;  // дождаться ввода в std::cin, не занимая рабочий поток
+    Task<bool> waitKeys(std::string& keys, int timeoutMs = -1) const;  // как InputReader::waitKeys, но в задаче
+    void       printBeforePlay() const;                                // вывод предыгровой информации
+    void       readme() const;                                         // инструкция, как играть
+    Task<>     handleChoice(short choice);                             // обработка выбора игрока
+    Task<>     printWhileMazeGenerating() const;  // вывод информации с ожиданием, пока генерация не закончена
+    void       printAboutChangingDLL() const;     // вывод об изменении уровня по умолчанию
+    Task<int>  processDLL() const;  // выбранный уровень по умолчанию или -1, если выбор отклонен
 
    public:
-    Player(GameField* gameField);
+    Player(GameField* gameField, LogComponent& logComponent);
 
-    void letsgo();  // публичный старт игры
+    Task<> letsgo();  // публичный старт игры
 };
\ No newline at end of file
@@ -22,5 +22,22 @@ const Position GAME_BEGIN = {ROWS / 2, 0}, GAME_END = {ROWS / 2, COLUMNS - 1};
 const Position UP_POS = {-1, 0}, DOWN_POS = {1, 0}, LEFT_POS = {0, -1}, RIGHT_POS = {0, 1};
 // важно помнить, что в программировании будут не совсем те координаты
 
+struct MoveDirection {  // клавиша движения
+    char        key;     // клавиша (строчная)
+    Position    offset;  // смещение позиции
+    const char* name;    // для журнала: "moving up", "failed to move up"
+};
+
+const MoveDirection MOVE_DIRECTIONS[DIRECTION_SIZE] = {
+    {'w', UP_POS, "up"}, {'s', DOWN_POS, "down"}, {'a', LEFT_POS, "left"}, {'d', RIGHT_POS, "right"}};
+
+inline const MoveDirection* findMoveDirection(char move) {  // nullptr - не клавиша движения
+    if (move >= 'A' && move <= 'Z') move = static_cast<char>(move - 'A' + 'a');
+    for (const auto& direction : MOVE_DIRECTIONS) {
+        if (direction.key == move) return &direction;
+    }
+    return nullptr;
+}
+
 enum Choice { PLAY, CHANGE_DLL };
 enum Direction { UP, DOWN, LEFT, RIGHT };
\ No newline at end of file
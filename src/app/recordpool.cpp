@@ -0,0 +1,113 @@
+#include "recordpool.h"
+
+#include <algorithm>
+#include <cstring>
+
+LogRecordPool::LogRecordPool() : slabCount_(0), freeHead_(0) {
+    for (auto& slab : slabs_) slab.store(nullptr, std::memory_order_relaxed);
+}
+
+LogRecordPool::~LogRecordPool() {
+    for (auto& slab : slabs_) delete[] slab.load(std::memory_order_relaxed);
+}
+
+LogSlot& LogRecordPool::getSlot(uint32_t index) const {
+    return slabs_[index / LOG_SLAB_SIZE].load(std::memory_order_acquire)[index % LOG_SLAB_SIZE];
+}
+
+LogSlot* LogRecordPool::pop() {
+    // стек Трайбера: счетчик в старших битах вершины меняется при каждом снятии,
+    // поэтому ячейка, которую успели снять и вернуть, не пройдет сравнение (ABA)
+    uint64_t head = freeHead_.load(std::memory_order_acquire);
+    while (true) {
+        const uint32_t top = static_cast<uint32_t>(head);
+        if (top == 0) {
+            if (!grow()) return nullptr;
+            head = freeHead_.load(std::memory_order_acquire);
+            continue;
+        }
+
+        LogSlot&       slot    = getSlot(top - 1);
+        const uint64_t newHead = ((head >> 32) + 1) << 32 | slot.next.load(std::memory_order_relaxed);
+        if (freeHead_.compare_exchange_weak(head, newHead, std::memory_order_acquire, std::memory_order_acquire)) {
+            slot.next.store(0, std::memory_order_relaxed);
+            return &slot;
+        }
+    }
+}
+
+void LogRecordPool::push(LogSlot& first, LogSlot& last) {
+    uint64_t head = freeHead_.load(std::memory_order_relaxed);
+    do {
+        last.next.store(static_cast<uint32_t>(head), std::memory_order_relaxed);
+    } while (!freeHead_.compare_exchange_weak(head, (head >> 32 << 32) | (first.index + 1), std::memory_order_release,
+                                              std::memory_order_relaxed));
+}
+
+bool LogRecordPool::grow() {
+    std::lock_guard<std::mutex> lock(growMutex_);
+    if (static_cast<uint32_t>(freeHead_.load(std::memory_order_acquire)) != 0) return true;  // уже выросли
+
+    const uint32_t count = slabCount_.load(std::memory_order_relaxed);
+    if (count == LOG_MAX_SLABS) return false;
+
+    // ячейки нового блока уже связаны друг с другом и уходят в свободный список одной цепочкой
+    LogSlot*       slab  = new LogSlot[LOG_SLAB_SIZE];
+    const uint32_t first = count * static_cast<uint32_t>(LOG_SLAB_SIZE);
+    for (uint32_t i = 0; i != LOG_SLAB_SIZE; ++i) {
+        slab[i].index = first + i;
+        slab[i].next.store(first + i + 2, std::memory_order_relaxed);
+    }
+
+    slabs_[count].store(slab, std::memory_order_release);
+    slabCount_.store(count + 1, std::memory_order_release);
+    push(slab[0], slab[LOG_SLAB_SIZE - 1]);
+    return true;
+}
+
+LogSlot* LogRecordPool::acquire(std::string_view message, const LogEvent& event, LogLevel logLevel) {
+    LogSlot* first = pop();
+    if (first == nullptr) return nullptr;
+
+    first->event    = event;
+    first->logLevel = logLevel;
+    first->size     = static_cast<uint32_t>(message.size());
+
+    // хвост длинного текста - по LOG_SLOT_TEXT_SIZE в каждую следующую ячейку цепочки
+    LogSlot* last = first;
+    for (size_t offset = 0;;) {
+        const size_t size = std::min(message.size() - offset, LOG_SLOT_TEXT_SIZE);
+        std::memcpy(last->text, message.data() + offset, size);
+        offset += size;
+        if (offset == message.size()) break;
+
+        LogSlot* chunk = pop();
+        if (chunk == nullptr) {
+            release(first);
+            return nullptr;
+        }
+        last->next.store(chunk->index + 1, std::memory_order_relaxed);
+        last = chunk;
+    }
+
+    return first;
+}
+
+void LogRecordPool::release(LogSlot* slot) {
+    LogSlot* last = slot;
+    for (uint32_t next; (next = last->next.load(std::memory_order_relaxed)) != 0;) last = &getSlot(next - 1);
+    push(*slot, *last);
+}
+
+std::string_view LogRecordPool::getText(const LogSlot& slot, std::string& scratch) const {
+    if (slot.size <= LOG_SLOT_TEXT_SIZE) return std::string_view(slot.text, slot.size);
+
+    scratch.clear();
+    for (const LogSlot* chunk = &slot;; chunk = &getSlot(chunk->next.load(std::memory_order_relaxed) - 1)) {
+        scratch.append(chunk->text, std::min(slot.size - scratch.size(), LOG_SLOT_TEXT_SIZE));
+        if (scratch.size() == slot.size) break;
+    }
+    return scratch;
+}
+
+size_t LogRecordPool::getSlabCount() const { return slabCount_.load(std::memory_order_acquire); }
\ No newline at end of file
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <logger/logger.h>
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+
+// записи очереди журнала лежат в ячейках фиксированного размера: короткий текст помещается в саму ячейку,
+// длинный продолжается цепочкой таких же ячеек. ячейки выделяются блоками только пока пул растет,
+// дальше они ходят по кругу через свободный список без блокировок: производители берут, поток журнала возвращает
+
+constexpr size_t LOG_SLOT_TEXT_SIZE = 96;    // текста в одной ячейке
+constexpr size_t LOG_SLAB_SIZE      = 256;   // ячеек в одном блоке
+constexpr size_t LOG_MAX_SLABS      = 1024;  // предел роста пула, дальше acquire возвращает nullptr
+
+struct LogSlot {  // запись очереди журнала или продолжение длинного текста
+    std::atomic<uint32_t> next;      // номер следующей ячейки + 1 (в цепочке текста или в свободном списке), 0 - нет
+    uint32_t              index;     // номер ячейки в пуле
+    uint32_t              size;      // длина всего текста (в первой ячейке цепочки)
+    LogLevel              logLevel;  // уровень важности
+    uint64_t              ticks;     // часы журнала (LogClock) в момент постановки в очередь
+    LogEvent              event;     // событие, если event.name задано
+    char                  text[LOG_SLOT_TEXT_SIZE];
+};
+
+class LogRecordPool {  // пул ячеек для записей журнала, без malloc/free после разгона
+   private:
+    std::atomic<LogSlot*> slabs_[LOG_MAX_SLABS];  // блоки ячеек, живут до конца пула
+    std::atomic<uint32_t> slabCount_;             // сколько блоков выделено
+    std::atomic<uint64_t> freeHead_;              // вершина свободного списка: счетчик ABA << 32 | номер + 1
+    std::mutex            growMutex_;             // рост пула, только когда свободных ячеек нет
+
+    LogSlot& getSlot(uint32_t index) const;        // ячейка по номеру
+    LogSlot* pop();                                // ячейка из свободного списка, nullptr - пул исчерпан
+    void     push(LogSlot& first, LogSlot& last);  // вернуть цепочку first..last в свободный список
+    bool     grow();                               // новый блок ячеек, false - предел роста
+
+   public:
+    LogRecordPool();
+    ~LogRecordPool();
+
+    LogRecordPool(const LogRecordPool&)            = delete;
+    LogRecordPool& operator=(const LogRecordPool&) = delete;
+
+    LogSlot*         acquire(std::string_view message, const LogEvent& event,
+                             LogLevel logLevel);  // запись в ячейках пула, nullptr - пул исчерпан
+    void             release(LogSlot* slot);      // вернуть запись со всей цепочкой текста
+    std::string_view getText(const LogSlot& slot,
+                             std::string& scratch) const;  // текст записи, длинный собирается в scratch
+    size_t           getSlabCount() const;                 // сколько блоков выделено
+};
\ No newline at end of file
@@ -0,0 +1,248 @@
+#include "scheduler.h"
+
+#include <logger/affinity.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <stdexcept>
+#include <thread>
+
+thread_local bool isSchedulerWorker = false;  // поток выполняет задачи планировщика
+
+TaskWaitAwaiter::TaskWaitAwaiter(TaskScheduler& scheduler, TaskEvent* event, int fd, std::chrono::nanoseconds timeout)
+    : scheduler_(scheduler),
+      event_(event),
+      fd_(fd),
+      hasDeadline_(timeout.count() >= 0),
+      deadline_(std::chrono::steady_clock::now() +
+                std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::max(timeout, timeout.zero()))),
+      wait_(std::make_shared<TaskWait>()) {}
+
+bool TaskWaitAwaiter::await_suspend(std::coroutine_handle<> handle) {
+    // после постановки ожидания задачу может продолжить другой поток, и этого объекта уже не будет:
+    // всё нужное копируется заранее, а постановка - последнее действие
+    wait_->handle = handle;
+    TaskScheduler&                              scheduler   = scheduler_;
+    const TaskWaitPtr                           wait        = wait_;
+    const int                                   fd          = fd_;
+    const bool                                  hasDeadline = hasDeadline_;
+    const std::chrono::steady_clock::time_point deadline    = deadline_;
+
+    if (event_ == nullptr) {
+        scheduler.subscribe(wait, fd, hasDeadline, deadline);
+        return true;
+    }
+
+    std::lock_guard<std::mutex> lock(event_->mutex_);
+    if (event_->isSignaled_) {
+        event_->isSignaled_ = false;
+        wait->result        = true;
+        return false;
+    }
+    event_->waiter_    = wait;
+    event_->scheduler_ = &scheduler;
+    if (hasDeadline) scheduler.subscribe(wait, -1, true, deadline);
+    return true;
+}
+
+TaskEvent::TaskEvent() : isSignaled_(false), scheduler_(nullptr) {}
+
+void TaskEvent::notify() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    // ждущий мог уже уйти по таймауту: тогда событие достанется следующему wait
+    if (waiter_ != nullptr && scheduler_->complete(waiter_, true)) {
+        waiter_.reset();
+        return;
+    }
+    waiter_.reset();
+    isSignaled_ = true;
+}
+
+TaskWaitAwaiter TaskEvent::wait(TaskScheduler& scheduler, std::chrono::nanoseconds timeout) {
+    return TaskWaitAwaiter(scheduler, this, -1, timeout);
+}
+
+TaskScheduler::TaskScheduler(size_t workerCount)
+    : workerCount_(workerCount), wakeFd_(eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK)), isPolling_(false) {
+    if (workerCount_ == 0) throw std::invalid_argument("Invalid worker count: 0");
+    if (wakeFd_ < 0) throw std::runtime_error("Error: creating scheduler eventfd!");
+}
+
+TaskScheduler::~TaskScheduler() {
+    // незавершенные задачи удаляются вместе с планировщиком. удаляется кадр задачи spawn: он владеет кадрами
+    // задач, которых ждет, так что уходят и уснувшие на таймере, дескрипторе или событии, а в ready_
+    // и ожиданиях остаются только ссылки на них. ожидания помечаются завершенными, их никто не продолжит
+    for (; !timers_.empty(); timers_.pop()) timers_.top().wait->isDone.store(true);
+    for (const auto& watch : watches_) watch.wait->isDone.store(true);
+    for (const auto handle : tasks_) handle.destroy();
+    close(wakeFd_);
+}
+
+void TaskScheduler::spawn(Task<> task) {
+    auto handle                = task.release();
+    handle.promise().scheduler = this;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    tasks_.push_back(handle);
+    ready_.push_back(handle);
+    wakeLocked();
+}
+
+void TaskScheduler::pinWorkers(const std::vector<int>& cpus) {
+    // процессор вне разрешенных процессу не даст привязать поток: проверяем сразу, а не в рабочем потоке
+    const std::vector<int> allowed = getThreadCpus();
+    for (const int cpu : cpus) {
+        if (!std::binary_search(allowed.begin(), allowed.end(), cpu))
+            throw std::invalid_argument("Invalid CPU: " + std::to_string(cpu));
+    }
+    cpus_ = cpus;
+}
+
+void TaskScheduler::run() {
+    // вызывающий поток - тоже рабочий: его привязка на время run, потом прежняя
+    const std::vector<int>   savedCpus = cpus_.empty() ? std::vector<int>() : getThreadCpus();
+    std::vector<std::thread> workers;
+    for (size_t i = 1; i < workerCount_; ++i) workers.emplace_back([this, i]() { work(i); });
+    work(0);
+    for (auto& worker : workers) worker.join();
+    if (!savedCpus.empty()) pinCurrentThread(savedCpus);
+
+    if (exception_) std::rethrow_exception(std::exchange(exception_, nullptr));
+}
+
+void TaskScheduler::work(size_t index) {
+    isSchedulerWorker = true;
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (!cpus_.empty()) {
+        try {
+            pinCurrentThread({cpus_[index % cpus_.size()]});
+        } catch (const std::exception&) {
+            if (!exception_) exception_ = std::current_exception();  // поток работает и без привязки
+        }
+    }
+
+    while (true) {
+        const auto now = std::chrono::steady_clock::now();
+        while (!timers_.empty() && (timers_.top().deadline <= now || timers_.top().wait->isDone.load())) {
+            completeLocked(timers_.top().wait, false);
+            timers_.pop();
+        }
+
+        if (!ready_.empty()) {
+            const auto handle = ready_.front();
+            ready_.pop_front();
+            lock.unlock();
+            handle.resume();
+            lock.lock();
+            continue;
+        }
+        if (tasks_.empty()) break;
+
+        watches_.erase(std::remove_if(watches_.begin(), watches_.end(),
+                                      [](const FdWatch& watch) { return watch.wait->isDone.load(); }),
+                       watches_.end());
+        if (!watches_.empty() && !isPolling_) {
+            pollOnce(lock);
+        } else if (!timers_.empty()) {
+            condVar_.wait_until(lock, timers_.top().deadline);
+        } else {
+            condVar_.wait(lock);
+        }
+    }
+
+    wakeLocked(true);  // остальные потоки тоже должны увидеть, что задач не осталось
+    isSchedulerWorker = false;
+}
+
+void TaskScheduler::pollOnce(std::unique_lock<std::mutex>& lock) {
+    isPolling_ = true;
+    pollFds_.assign(1, pollfd{wakeFd_, POLLIN, 0});
+    for (const auto& watch : watches_) pollFds_.push_back(pollfd{watch.fd, POLLIN, 0});
+
+    int timeoutMs = -1;
+    if (!timers_.empty()) {
+        const auto left = std::chrono::ceil<std::chrono::milliseconds>(timers_.top().deadline -
+                                                                       std::chrono::steady_clock::now());
+        timeoutMs       = static_cast<int>(std::max<int64_t>(0, left.count()));
+    }
+
+    lock.unlock();
+    const int count = poll(pollFds_.data(), pollFds_.size(), timeoutMs);
+    lock.lock();
+    isPolling_ = false;
+    if (count <= 0) return;
+
+    if (pollFds_[0].revents != 0) {
+        uint64_t value;
+        (void)!read(wakeFd_, &value, sizeof(value));
+    }
+    // за время poll список мог пополниться: готовность ищем по номеру дескриптора
+    for (size_t i = 1; i != pollFds_.size(); ++i) {
+        if (pollFds_[i].revents == 0) continue;
+        for (const auto& watch : watches_) {
+            if (watch.fd == pollFds_[i].fd) completeLocked(watch.wait, true);
+        }
+    }
+}
+
+bool TaskScheduler::completeLocked(const TaskWaitPtr& wait, bool result) {
+    if (wait->isDone.exchange(true)) return false;
+    wait->result = result;
+    ready_.push_back(wait->handle);
+    wakeLocked();
+    return true;
+}
+
+bool TaskScheduler::complete(const TaskWaitPtr& wait, bool result) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return completeLocked(wait, result);
+}
+
+void TaskScheduler::wakeLocked(bool isAll) {
+    // поток на poll не слышит условную переменную - его будит eventfd
+    if (isAll)
+        condVar_.notify_all();
+    else
+        condVar_.notify_one();
+    if (isPolling_) {
+        const uint64_t value = 1;
+        (void)!write(wakeFd_, &value, sizeof(value));
+    }
+}
+
+void TaskScheduler::subscribe(const TaskWaitPtr& wait, int fd, bool hasDeadline,
+                              std::chrono::steady_clock::time_point deadline) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (fd < 0 && hasDeadline && deadline <= std::chrono::steady_clock::now()) {
+        completeLocked(wait, false);  // yield и нулевые таймауты - сразу в конец очереди
+        return;
+    }
+
+    if (fd >= 0) watches_.push_back({fd, wait});
+    if (hasDeadline) timers_.push({deadline, wait});
+    wakeLocked(true);  // свободным потокам нужно пересчитать ожидание: новый дескриптор или более ранний таймер
+}
+
+void TaskScheduler::finish(std::coroutine_handle<> handle, std::exception_ptr exception) {
+    // кадр уже удален: адрес нужен только чтобы найти задачу
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (exception && !exception_) exception_ = exception;
+    *std::find(tasks_.begin(), tasks_.end(), handle) = tasks_.back();
+    tasks_.pop_back();
+    if (tasks_.empty()) wakeLocked(true);
+}
+
+TaskWaitAwaiter TaskScheduler::yield() { return TaskWaitAwaiter(*this, nullptr, -1, std::chrono::nanoseconds(0)); }
+
+TaskWaitAwaiter TaskScheduler::sleepFor(std::chrono::nanoseconds duration) {
+    return TaskWaitAwaiter(*this, nullptr, -1, std::max(duration, duration.zero()));
+}
+
+TaskWaitAwaiter TaskScheduler::waitReadable(int fd, std::chrono::nanoseconds timeout) {
+    return TaskWaitAwaiter(*this, nullptr, fd, timeout);
+}
+
+size_t TaskScheduler::getWorkerCount() const { return workerCount_; }
+
+bool TaskScheduler::isWorkerThread() { return isSchedulerWorker; }
\ No newline at end of file
@@ -0,0 +1,228 @@
+#pragma once
+
+#include <poll.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <coroutine>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <queue>
+#include <utility>
+#include <vector>
+
+// задачи приложения - сопрограммы C++20 на нескольких рабочих потоках вместо отдельного потока на каждую.
+// ожидая (другой задачи, времени, готовности дескриптора или события), задача не держит поток:
+// один свободный рабочий поток ждет на poll все дескрипторы и ближайший таймер, остальные - на условной переменной
+
+constexpr size_t APP_WORKER_COUNT = 2;  // рабочих потоков приложения по умолчанию
+
+class TaskScheduler;
+
+template <typename T = void>
+class Task;
+
+struct TaskPromiseBase {  // общее для обещаний всех задач
+    std::coroutine_handle<> continuation;  // задача, ждущая эту (co_await), пусто - запущена через spawn
+    TaskScheduler*          scheduler;     // для запущенной через spawn: кому сообщить о завершении
+    std::exception_ptr      exception;     // исключение задачи, передается ждущему
+    std::atomic<bool>       handoff;       // второй из двух (ждущая уснула, задача завершилась) продолжает ждущую
+
+    struct FinalAwaiter {  // в конце задачи: продолжить ждущую или удалить себя и сообщить планировщику
+        bool await_ready() noexcept { return false; }
+        template <typename Promise>
+        void await_suspend(std::coroutine_handle<Promise> handle) noexcept;
+        void await_resume() noexcept {}
+    };
+
+    TaskPromiseBase() : scheduler(nullptr), handoff(false) {}
+
+    std::suspend_always initial_suspend() noexcept { return {}; }  // задача ленивая: стартует при co_await/spawn
+    FinalAwaiter        final_suspend() noexcept { return {}; }
+    void                unhandled_exception() { exception = std::current_exception(); }
+    void                rethrowIfFailed() const {
+        if (exception) std::rethrow_exception(exception);
+    }
+};
+
+template <typename T>
+struct TaskPromise : TaskPromiseBase {
+    std::optional<T> value;  // результат задачи
+
+    Task<T> get_return_object();
+    void    return_value(T result) { value = std::move(result); }
+    T       takeResult() {
+        rethrowIfFailed();
+        return std::move(*value);
+    }
+};
+
+template <>
+struct TaskPromise<void> : TaskPromiseBase {
+    Task<void> get_return_object();
+    void       return_void() {}
+    void       takeResult() { rethrowIfFailed(); }
+};
+
+template <typename T>
+class Task {  // сопрограмма с результатом T; co_await task запускает её и ждет без блокировки потока
+   public:
+    using promise_type = TaskPromise<T>;
+    using Handle       = std::coroutine_handle<promise_type>;
+
+   private:
+    Handle handle_;  // кадр сопрограммы, удаляется вместе с задачей
+
+   public:
+    explicit Task(Handle handle) : handle_(handle) {}
+    Task(Task&& other) noexcept : handle_(std::exchange(other.handle_, nullptr)) {}
+    Task(const Task&)            = delete;
+    Task& operator=(const Task&) = delete;
+    ~Task() {
+        if (handle_) handle_.destroy();
+    }
+
+    Handle release() { return std::exchange(handle_, nullptr); }  // кадр переходит планировщику
+
+    auto operator co_await() noexcept {
+        struct Awaiter {
+            Handle handle;
+
+            bool await_ready() noexcept { return false; }
+            bool await_suspend(std::coroutine_handle<> caller) noexcept {
+                // сразу в задачу, без очереди планировщика. завершилась, не уснув, - ждущая продолжает
+                // сама, а не из конца задачи: иначе каждый такой co_await в цикле углублял бы стек
+                handle.promise().continuation = caller;
+                handle.resume();
+                return !handle.promise().handoff.exchange(true, std::memory_order_acq_rel);
+            }
+            T await_resume() { return handle.promise().takeResult(); }
+        };
+        return Awaiter{handle_};
+    }
+};
+
+template <typename T>
+Task<T> TaskPromise<T>::get_return_object() {
+    return Task<T>(Task<T>::Handle::from_promise(*this));
+}
+
+inline Task<void> TaskPromise<void>::get_return_object() { return Task<void>(Task<void>::Handle::from_promise(*this)); }
+
+struct TaskWait {  // одно ожидание: задачу продолжает первый из таймера, дескриптора и события
+    std::coroutine_handle<> handle;  // ждущая задача
+    std::atomic<bool>       isDone;  // ожидание уже завершено, остальные источники его пропускают
+    bool                    result;  // true - дождались, false - истек таймаут
+
+    TaskWait() : isDone(false), result(false) {}
+};
+
+using TaskWaitPtr = std::shared_ptr<TaskWait>;
+
+class TaskEvent;
+
+class TaskWaitAwaiter {  // co_await для sleepFor, waitReadable, yield и TaskEvent::wait
+   private:
+    TaskScheduler&                        scheduler_;
+    TaskEvent*                            event_;        // ждем события или nullptr
+    int                                   fd_;           // ждем готовности дескриптора или -1
+    bool                                  hasDeadline_;  // ограничено временем
+    std::chrono::steady_clock::time_point deadline_;     // до какого момента ждем
+    TaskWaitPtr                           wait_;         // общее с источниками пробуждения
+
+   public:
+    TaskWaitAwaiter(TaskScheduler& scheduler, TaskEvent* event, int fd, std::chrono::nanoseconds timeout);
+
+    bool await_ready() const noexcept { return false; }
+    bool await_suspend(std::coroutine_handle<> handle);  // false - продолжить сразу (событие уже было)
+    bool await_resume() const noexcept { return wait_->result; }
+};
+
+class TaskEvent {  // с автосбросом: notify будит ждущую задачу или запоминается до следующего wait
+   private:
+    std::mutex     mutex_;
+    bool           isSignaled_;  // notify без ждущего
+    TaskWaitPtr    waiter_;      // ждущая задача (одна)
+    TaskScheduler* scheduler_;   // её планировщик
+
+    friend class TaskWaitAwaiter;
+
+   public:
+    TaskEvent();
+
+    void            notify();  // можно звать из любого потока, в том числе не рабочего
+    TaskWaitAwaiter wait(TaskScheduler& scheduler, std::chrono::nanoseconds timeout = std::chrono::nanoseconds(-1));
+};
+
+class TaskScheduler {  // очередь готовых задач, таймеры и дескрипторы на нескольких рабочих потоках
+   private:
+    struct Timer {
+        std::chrono::steady_clock::time_point deadline;
+        TaskWaitPtr                           wait;
+        bool operator>(const Timer& other) const { return deadline > other.deadline; }
+    };
+    struct FdWatch {
+        int         fd;
+        TaskWaitPtr wait;
+    };
+
+    size_t                                                         workerCount_;  // рабочих потоков в run
+    std::mutex                                                     mutex_;        // для всего ниже
+    std::condition_variable                                        condVar_;      // будит свободные потоки
+    std::deque<std::coroutine_handle<>>                            ready_;        // готовые к продолжению
+    std::priority_queue<Timer, std::vector<Timer>, std::greater<>> timers_;       // ближайший - сверху
+    std::vector<FdWatch>                                           watches_;      // ждущие готовности дескриптора
+    std::vector<pollfd>                                            pollFds_;      // только у потока на poll
+    int                                                            wakeFd_;       // eventfd: будит поток на poll
+    bool                                                           isPolling_;    // кто-то ждет на poll
+    std::vector<std::coroutine_handle<>>                           tasks_;        // незавершенные задачи spawn
+    std::exception_ptr                                             exception_;    // первое исключение задач
+    std::vector<int>                                               cpus_;         // рабочий i - на cpus_[i % size]
+
+    friend class TaskWaitAwaiter;
+    friend struct TaskPromiseBase;
+
+    void work(size_t index);                                    // цикл рабочего потока
+    void pollOnce(std::unique_lock<std::mutex>& lock);          // ждать дескрипторы и ближайший таймер
+    bool completeLocked(const TaskWaitPtr& wait, bool result);  // под mutex_: продолжить задачу, если еще ждет
+    void wakeLocked(bool isAll = false);                        // под mutex_: разбудить свободные потоки
+    void subscribe(const TaskWaitPtr& wait, int fd, bool hasDeadline,
+                   std::chrono::steady_clock::time_point deadline);  // поставить ожидание
+    void finish(std::coroutine_handle<> handle, std::exception_ptr exception);  // задача spawn завершилась
+
+   public:
+    explicit TaskScheduler(size_t workerCount = APP_WORKER_COUNT);
+    ~TaskScheduler();
+
+    void spawn(Task<> task);                              // запустить задачу, до или во время run
+    void pinWorkers(const std::vector<int>& cpus);        // привязать рабочие потоки к процессорам, до run
+    void run();  // выполнять задачи, пока не завершатся все; первое исключение задачи - отсюда
+    bool complete(const TaskWaitPtr& wait, bool result);  // продолжить ожидание (для TaskEvent)
+
+    TaskWaitAwaiter yield();                                       // пропустить вперед другие задачи
+    TaskWaitAwaiter sleepFor(std::chrono::nanoseconds duration);  // подождать, не занимая поток
+    TaskWaitAwaiter waitReadable(int fd, std::chrono::nanoseconds timeout = std::chrono::nanoseconds(-1));
+    size_t          getWorkerCount() const;  // рабочих потоков
+    static bool     isWorkerThread();        // текущий поток - рабочий: блокироваться в нем нельзя
+};
+
+template <typename Promise>
+void TaskPromiseBase::FinalAwaiter::await_suspend(std::coroutine_handle<Promise> handle) noexcept {
+    TaskPromiseBase& promise = handle.promise();
+    if (promise.continuation) {
+        // ждущая уже уснула - задача завершилась на другом потоке или после ожидания, продолжаем её отсюда
+        if (promise.handoff.exchange(true, std::memory_order_acq_rel)) promise.continuation.resume();
+        return;
+    }
+
+    // задача запущена через spawn: её никто не ждет, кадр удаляем сами
+    TaskScheduler*     scheduler = promise.scheduler;
+    std::exception_ptr exception = promise.exception;
+    handle.destroy();
+    scheduler->finish(handle, exception);
+}
\ No newline at end of file
@@ -0,0 +1,246 @@
+#include "server.h"
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+constexpr size_t MAX_COMMAND_SIZE = 4096;       // строка длиннее - клиент отключается
+constexpr size_t MAX_OUTPUT_SIZE  = 64 * 1024;  // столько неотправленных ответов - и команды больше не читаются
+constexpr int    MAX_EPOLL_EVENTS = 64;
+
+GameServer::GameServer(const std::string& socketPath, Logger& logger, size_t threadCount, MazePool* mazePool)
+    : socketPath_(socketPath),
+      logger_(logger),
+      logComponent_(&logger.getComponent("Server")),
+      listenFd_(-1),
+      epollFd_(-1),
+      wakeFd_(-1),
+      running_(true),
+      sessionCount_(0),
+      mazePool_(mazePool),
+      pool_(threadCount) {
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (socketPath_.size() >= sizeof(address.sun_path)) throw std::invalid_argument("Error: socket path is too long!");
+    std::memcpy(address.sun_path, socketPath_.c_str(), socketPath_.size() + 1);
+
+    unlink(socketPath_.c_str());  // сокет от прошлого запуска
+    listenFd_ = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    epollFd_  = epoll_create1(EPOLL_CLOEXEC);
+    wakeFd_   = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+    epoll_event listenEvent{}, wakeEvent{};
+    listenEvent.events = wakeEvent.events = EPOLLIN;
+    listenEvent.data.fd                   = listenFd_;
+    wakeEvent.data.fd                     = wakeFd_;
+
+    if (listenFd_ < 0 || epollFd_ < 0 || wakeFd_ < 0 ||
+        bind(listenFd_, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+        listen(listenFd_, SOMAXCONN) != 0 || epoll_ctl(epollFd_, EPOLL_CTL_ADD, listenFd_, &listenEvent) != 0 ||
+        epoll_ctl(epollFd_, EPOLL_CTL_ADD, wakeFd_, &wakeEvent) != 0) {
+        const std::string error = std::strerror(errno);
+        for (const int fd : {listenFd_, epollFd_, wakeFd_}) {
+            if (fd >= 0) close(fd);
+        }
+        throw std::runtime_error("Error: starting game server: " + error + "!");
+    }
+
+    logComponent_->log("GameServer::GameServer | listening on " + socketPath_ + " with " +
+                           std::to_string(threadCount) + " worker threads.",
+                       WARNING);
+}
+
+GameServer::~GameServer() {
+    // сначала дожидаемся рабочих потоков, только потом закрываем сокеты
+    stop();
+    pool_.shutdown();
+
+    for (const auto& pair : sessions_) close(pair.first);
+    sessions_.clear();
+
+    close(listenFd_);
+    close(epollFd_);
+    close(wakeFd_);
+    unlink(socketPath_.c_str());
+}
+
+void GameServer::run() {
+    // поток цикла только ждет событий, а команды выполняет пул.
+    // EPOLLONESHOT гарантирует, что одну сессию обрабатывает не больше одного потока за раз,
+    // поэтому состоянию сессии блокировка не нужна
+    epoll_event events[MAX_EPOLL_EVENTS];
+
+    while (running_.load()) {
+        const int count = epoll_wait(epollFd_, events, MAX_EPOLL_EVENTS, -1);
+        if (count < 0) continue;  // EINTR
+
+        for (int i = 0; i != count; ++i) {
+            const int fd = events[i].data.fd;
+            if (fd == wakeFd_) continue;
+            if (fd == listenFd_) {
+                acceptClients();
+                continue;
+            }
+
+            GameSession* session;
+            {
+                std::lock_guard<std::mutex> lock(sessionsMutex_);
+                auto                        found = sessions_.find(fd);
+                if (found == sessions_.end()) continue;
+                session = found->second.get();
+            }
+
+            pool_.submit([this, session]() { serveClient(*session); });
+        }
+    }
+}
+
+void GameServer::acceptClients() {
+    while (true) {
+        const int fd = accept4(listenFd_, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) return;  // EAGAIN: больше никого нет
+
+        {
+            std::lock_guard<std::mutex> lock(sessionsMutex_);
+            sessions_[fd].reset(new GameSession{fd, SimulationEngine(&logger_.getComponent("Player"), false), false,
+                                                std::string(), std::string()});
+        }
+
+        epoll_event event{};
+        event.events  = EPOLLIN | EPOLLRDHUP | EPOLLONESHOT;
+        event.data.fd = fd;
+        epoll_ctl(epollFd_, EPOLL_CTL_ADD, fd, &event);
+
+        const size_t number = sessionCount_.fetch_add(1) + 1;
+        logComponent_->logEvent(LogEvent("GameServer::acceptClients", "session {} opened.",
+                                         {intField("session", static_cast<int64_t>(number))}));
+    }
+}
+
+void GameServer::serveClient(GameSession& session) {
+    // пока клиент не забрал ответы, новые команды не читаем: поток пула не ждет медленного клиента,
+    // а сессия ждет в epoll готовности сокета к записи
+    bool isClosed = !sendOutput(session);
+    char buffer[4096];
+    while (!isClosed && session.output.size() < MAX_OUTPUT_SIZE) {
+        const ssize_t size = read(session.fd, buffer, sizeof(buffer));
+        if (size > 0) {
+            session.input.append(buffer, static_cast<size_t>(size));
+            handleInput(session);
+            // строка без конца не растет без предела, даже если клиент шлет ее непрерывно
+            if (session.input.size() > MAX_COMMAND_SIZE) isClosed = true;
+        } else if (size < 0 && errno == EINTR) {
+            continue;
+        } else {
+            isClosed = size == 0 || errno != EAGAIN;
+            break;
+        }
+    }
+
+    if (!sendOutput(session) || isClosed) {
+        closeSession(session.fd);
+        return;
+    }
+
+    epoll_event event{};
+    event.events  = (session.output.empty() ? EPOLLIN : EPOLLOUT) | EPOLLRDHUP | EPOLLONESHOT;
+    event.data.fd = session.fd;
+    epoll_ctl(epollFd_, EPOLL_CTL_MOD, session.fd, &event);
+}
+
+void GameServer::handleInput(GameSession& session) {
+    size_t begin = 0, end;
+    while ((end = session.input.find('\n', begin)) != std::string::npos) {
+        session.output += handleCommand(session, std::string_view(session.input).substr(begin, end - begin));
+        session.output += '\n';
+        begin = end + 1;
+    }
+    session.input.erase(0, begin);
+}
+
+bool GameServer::sendOutput(GameSession& session) {
+    // отправляем, сколько примет сокет; остаток ждет следующего EPOLLOUT
+    size_t sent = 0;
+    while (sent != session.output.size()) {
+        const ssize_t size =
+            send(session.fd, session.output.data() + sent, session.output.size() - sent, MSG_NOSIGNAL);
+        if (size > 0)
+            sent += static_cast<size_t>(size);
+        else if (size < 0 && errno == EINTR)
+            continue;
+        else if (size < 0 && errno == EAGAIN)
+            break;
+        else
+            return false;
+    }
+    session.output.erase(0, sent);
+    return true;
+}
+
+void GameServer::closeSession(int fd) {
+    // сокет закрываем последним: иначе номер может достаться новому соединению раньше, чем уйдет из sessions_
+    epoll_ctl(epollFd_, EPOLL_CTL_DEL, fd, nullptr);
+    {
+        std::lock_guard<std::mutex> lock(sessionsMutex_);
+        sessions_.erase(fd);
+    }
+    close(fd);
+}
+
+std::string GameServer::handleCommand(GameSession& session, std::string_view line) {
+    if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+
+    if (line == "NEW") {
+        if (mazePool_ == nullptr) return "ERROR no maze pack, send NEW <seed>";
+
+        session.isStarted = true;
+        return "OK " + std::to_string(session.engine.load(*mazePool_));
+    }
+
+    if (line.rfind("NEW ", 0) == 0) {
+        unsigned seed;
+        try {
+            seed = static_cast<unsigned>(std::stoul(std::string(line.substr(4))));
+        } catch (const std::exception&) {
+            return "ERROR invalid seed";
+        }
+
+        session.isStarted = true;
+        return "OK " + std::to_string(session.engine.generate(seed));
+    }
+
+    if (line.rfind("MOVE ", 0) == 0) {
+        if (!session.isStarted) return "ERROR no game, send NEW <seed> first";
+
+        const SimulationResult result = session.engine.run(line.substr(5));
+        return "AT " + std::to_string(result.position.x) + ' ' + std::to_string(result.position.y) +
+               (result.isFinished ? " FINISHED" : " PLAYING");
+    }
+
+    if (line == "HINT") {
+        if (!session.isStarted) return "ERROR no game, send NEW <seed> first";
+
+        // расстояния посчитаны при генерации, поэтому подсказка не зависит от размера лабиринта
+        const GameField&     gameField = session.engine.getGameField();
+        const MoveDirection* hint      = gameField.getHint(session.engine.getPosition());
+        return std::string("HINT ") + (hint != nullptr ? hint->key : '-') + ' ' +
+               std::to_string(gameField.getDistance(session.engine.getPosition()));
+    }
+
+    logComponent_->log("GameServer::handleCommand | unknown command.", ERROR);
+    return "ERROR unknown command";
+}
+
+void GameServer::stop() {
+    running_.store(false);
+    const uint64_t one = 1;
+    (void)!write(wakeFd_, &one, sizeof(one));
+}
+
+size_t GameServer::getSessionCount() const { return sessionCount_.load(); }
\ No newline at end of file
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <logger/logger.h>
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+
+#include "simulation.h"
+#include "threadpool.h"
+
+// протокол построчный, на каждую команду - одна строка ответа:
+//   NEW <seed>      -> OK <attempts>                      новый лабиринт для этого соединения
+//   NEW             -> OK <attempts>                      готовый лабиринт из набора (если он задан)
+//   MOVE <wasd...>  -> AT <x> <y> <PLAYING|FINISHED>      ходы как в игре
+//   HINT            -> HINT <w|a|s|d|-> <distance>        лучший ход и сколько ходов осталось
+//   другое          -> ERROR <text>
+
+struct GameSession {  // состояние одного соединения
+    int              fd;         // сокет клиента
+    SimulationEngine engine;     // свое поле и позиция игрока
+    bool             isStarted;  // была ли команда NEW
+    std::string      input;      // недочитанная строка
+    std::string      output;     // ответы, которые сокет еще не принял
+};
+
+class GameServer {  // много игр в одном процессе: epoll на Unix-сокете и фиксированный пул потоков
+   private:
+    std::string                                 socketPath_;     // путь к сокету
+    Logger&                                     logger_;         // общий журнал всех сессий
+    LogComponent*                               logComponent_;   // компонент журнала "Server"
+    int                                         listenFd_;       // слушающий сокет
+    int                                         epollFd_;        // epoll для всех сокетов
+    int                                         wakeFd_;         // eventfd для остановки
+    std::atomic<bool>                           running_;        // для остановки цикла
+    std::atomic<size_t>                         sessionCount_;   // сколько соединений принято
+    std::mutex                                  sessionsMutex_;  // для sessions_
+    std::map<int, std::unique_ptr<GameSession>> sessions_;       // открытые соединения по сокету
+    MazePool*                                   mazePool_;       // готовые лабиринты, может быть nullptr
+    ThreadPool                                  pool_;           // обработка команд
+
+    void        acceptClients();                                             // принять ожидающие соединения
+    void        serveClient(GameSession& session);                           // прочитать и выполнить команды
+    void        handleInput(GameSession& session);                           // выполнить прочитанные строки
+    bool        sendOutput(GameSession& session);                            // отправить ответы, false - ошибка
+    void        closeSession(int fd);                                        // закрыть соединение
+    std::string handleCommand(GameSession& session, std::string_view line);  // выполнить одну команду
+
+   public:
+    GameServer(const std::string& socketPath, Logger& logger, size_t threadCount = 4, MazePool* mazePool = nullptr);
+    ~GameServer();
+
+    void   run();                    // цикл событий, возвращается после stop
+    void   stop();                   // можно звать из другого потока и из обработчика сигнала
+    size_t getSessionCount() const;  // сколько соединений принято за все время
+};
\ No newline at end of file
@@ -0,0 +1,99 @@
+#include "session.h"
+
+#include <cstring>
+#include <iterator>
+#include <stdexcept>
+
+SessionRecorder::SessionRecorder(const std::string& filename)
+    : file_(filename, std::ios::binary | std::ios::trunc), lastTime_(0), isStarted_(false) {
+    if (!file_.is_open()) throw std::runtime_error("Error: creating session record!");
+}
+
+void SessionRecorder::start(unsigned seed, LogLevel logLevel) {
+    SessionHeader header{};
+    std::memcpy(header.magic, SESSION_MAGIC, sizeof(header.magic));
+    header.version  = SESSION_VERSION;
+    header.seed     = seed;
+    header.logLevel = static_cast<uint32_t>(logLevel);
+    header.startTime =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch())
+            .count();
+
+    file_.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file_.flush();
+    startTime_ = std::chrono::steady_clock::now();
+    isStarted_ = true;
+}
+
+void SessionRecorder::record(char move, int moveLevel, int chosenLevel) {
+    if (!isStarted_) return;
+
+    const auto    elapsed = std::chrono::steady_clock::now() - startTime_;
+    const int64_t time    = std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+    uint64_t delta = static_cast<uint64_t>(time - lastTime_);
+    lastTime_      = time;
+
+    // обычно между ходами меньше секунды: 1-3 байта на время
+    char buffer[16];
+    int  size = 0;
+    do {
+        buffer[size++] = static_cast<char>((delta & 0x7F) | (delta > 0x7F ? 0x80 : 0));
+        delta >>= 7;
+    } while (delta != 0);
+    buffer[size++] = move;
+    buffer[size++] = static_cast<char>(moveLevel < 0 ? SESSION_NO_LEVEL : moveLevel);
+    buffer[size++] = static_cast<char>(chosenLevel < 0 ? SESSION_NO_LEVEL : chosenLevel);
+
+    // ходов немного, поэтому сбрасываем сразу: запись переживет падение игры
+    file_.write(buffer, size);
+    file_.flush();
+}
+
+SessionRecording loadSession(const std::string& filename) {
+    std::ifstream file(filename, std::ios::binary);
+    if (!file.is_open()) throw std::runtime_error("Error: opening session record!");
+    const std::vector<uint8_t> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    SessionRecording recording{};
+    if (data.size() < sizeof(SessionHeader)) throw std::runtime_error("Error: invalid session record!");
+    std::memcpy(&recording.header, data.data(), sizeof(SessionHeader));
+    if (std::memcmp(recording.header.magic, SESSION_MAGIC, sizeof(SESSION_MAGIC)) != 0 ||
+        recording.header.version != SESSION_VERSION)
+        throw std::runtime_error("Error: invalid session record!");
+
+    // недописанный последний ход (падение во время записи) отбрасывается
+    int64_t time = 0;
+    for (size_t offset = sizeof(SessionHeader); offset < data.size();) {
+        uint64_t delta = 0;
+        int      shift = 0;
+        while (offset < data.size() && shift < 64) {
+            const uint8_t byte = data[offset++];
+            delta |= static_cast<uint64_t>(byte & 0x7F) << shift;
+            shift += 7;
+            if ((byte & 0x80) == 0) break;
+        }
+        if (offset + 3 > data.size()) break;
+
+        time += static_cast<int64_t>(delta);
+        recording.moves.push_back({time, static_cast<char>(data[offset]), data[offset + 1], data[offset + 2]});
+        offset += 3;
+    }
+
+    return recording;
+}
+
+SimulationResult replaySession(const SessionRecording& recording, LogComponent* logComponent) {
+    // лабиринт строится заново из зерна, ходы идут подряд без задержек и вывода на экран
+    auto getLevel = [](uint8_t level) { return level == SESSION_NO_LEVEL ? -1 : static_cast<int>(level); };
+
+    if (logComponent != nullptr) logComponent->changeLogLevel(static_cast<LogLevel>(recording.header.logLevel));
+
+    SimulationEngine engine(logComponent, false);
+    engine.generate(recording.header.seed);
+
+    SimulationResult result{GAME_BEGIN, 0, 0, 0, false};
+    for (const SessionMove& move : recording.moves)
+        engine.step(move.move, result, getLevel(move.moveLevel), getLevel(move.chosenLevel));
+
+    return result;
+}
\ No newline at end of file
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <logger/logger.h>
+
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "simulation.h"
+
+// запись игры: SessionHeader, затем ходы подряд, каждый ход:
+//   время от предыдущего хода в микросекундах (varint), клавиша, уровень из ввода, выбранный уровень
+// уровни: 0..2 - LogLevel, 0xFF - не задан
+
+constexpr char     SESSION_MAGIC[4] = {'G', 'S', 'R', 'C'};
+constexpr uint32_t SESSION_VERSION  = 1;
+constexpr uint8_t  SESSION_NO_LEVEL = 0xFF;
+
+struct SessionHeader {
+    char     magic[4];   // GSRC
+    uint32_t version;    // версия формата
+    uint32_t seed;       // зерно лабиринта
+    uint32_t logLevel;   // уровень журнала по умолчанию в начале игры
+    int64_t  startTime;  // начало игры, наносекунды от эпохи
+};
+
+struct SessionMove {
+    int64_t time;         // микросекунды от начала игры
+    char    move;         // клавиша
+    uint8_t moveLevel;    // уровень из ввода ("w ERROR")
+    uint8_t chosenLevel;  // для '1' - выбранный уровень по умолчанию
+};
+
+struct SessionRecording {
+    SessionHeader            header;
+    std::vector<SessionMove> moves;
+};
+
+class SessionRecorder {  // пишет ходы игрока по мере игры
+   private:
+    std::ofstream                         file_;       // файл записи
+    std::chrono::steady_clock::time_point startTime_;  // начало игры
+    int64_t                               lastTime_;   // время предыдущего хода, микросекунды
+    bool                                  isStarted_;  // заголовок уже записан
+
+   public:
+    explicit SessionRecorder(const std::string& filename);
+
+    void start(unsigned seed, LogLevel logLevel);  // начало игры: заголовок
+    void record(char move, int moveLevel = -1, int chosenLevel = -1);  // ход, уровни -1 - не заданы
+};
+
+SessionRecording loadSession(const std::string& filename);  // чтение записи целиком
+SimulationResult replaySession(const SessionRecording& recording,
+                               LogComponent* logComponent = nullptr);  // повтор без задержек, журнал - по желанию
\ No newline at end of file
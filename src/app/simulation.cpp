@@ -0,0 +1,117 @@
+#include "simulation.h"
+
+#include <chrono>
+
+SimulationEngine::SimulationEngine(LogComponent* logComponent, bool isRecording)
+    : gameField_(ROWS, COLUMNS),
+      position_(GAME_BEGIN),
+      logComponent_(logComponent),
+      isRecording_(isRecording),
+      startTime_(std::chrono::steady_clock::now()) {}
+
+void SimulationEngine::emit(const LogEvent& event, LogLevel logLevel) {
+    if (isRecording_) events_.push_back({event, logLevel});
+    if (logComponent_ != nullptr) logComponent_->logEvent(event, logLevel);
+}
+
+int SimulationEngine::generate(unsigned seed) {
+    const int countGen = gameField_.generate(seed);
+    position_          = GAME_BEGIN;
+    startTime_         = std::chrono::steady_clock::now();
+    events_.clear();
+
+    emit(LogEvent("GameField::calculateGameField", "{} attempts required for maze generation.",
+                  {intField("attempts", countGen)}),
+         INFO);
+    return countGen;
+}
+
+int SimulationEngine::load(MazePool& pool) {
+    const MazeInfo info = pool.take(gameField_);
+    position_           = GAME_BEGIN;
+    startTime_          = std::chrono::steady_clock::now();
+    events_.clear();
+
+    emit(LogEvent("GameField::calculateGameField", "{} attempts required for maze generation.",
+                  {intField("attempts", info.attempts)}),
+         INFO);
+    return info.attempts;
+}
+
+void SimulationEngine::restart() {
+    gameField_.clearPlayerPosition(position_);
+    position_ = GAME_BEGIN;
+    gameField_.setPlayerPosition(position_);
+    startTime_ = std::chrono::steady_clock::now();
+    events_.clear();
+}
+
+void SimulationEngine::step(char move, SimulationResult& result, int moveLevel, int chosenLevel) {
+    // та же логика, что в Player::processMove, но без std::cin, вывода на экран и задержек.
+    // уровень из ввода ("w ERROR") заменяет уровни всех событий хода, как parseLogLevelStringWithDefault
+    auto getLevel = [moveLevel](LogLevel defaultLevel) {
+        return moveLevel >= INFO && moveLevel <= ERROR ? static_cast<LogLevel>(moveLevel) : defaultLevel;
+    };
+
+    if (result.isFinished) return;
+    ++result.moveCount;
+    emit(LogEvent("Player::processMove", "data = {}", {charField("data", move)}), getLevel(INFO));
+
+    if (move == '1') {  // смена уровня важности: выбранный в диалоге уровень передается в chosenLevel
+        emit(LogEvent("Player::printAboutChangingDLL", "received instructions."), INFO);
+        if (chosenLevel < INFO || chosenLevel > ERROR) return;
+
+        if (logComponent_ != nullptr) logComponent_->changeLogLevel(static_cast<LogLevel>(chosenLevel));
+        emit(LogEvent("Player::processDLL", "changed default log level!"), INFO);
+        return;
+    }
+
+    const MoveDirection* direction = findMoveDirection(move);
+    if (direction == nullptr) {
+        ++result.invalidMoves;
+        emit(LogEvent("Player::processMove", "incorrect data = {}", {intField("data", move)}), getLevel(ERROR));
+        return;
+    }
+
+    const Position newPosition = {position_.x + direction->offset.x, position_.y + direction->offset.y};
+    if (!gameField_.canMove(newPosition)) {
+        ++result.failedMoves;
+        emit(LogEvent("Player::processMove", "failed to move {}.", {stringField("direction", direction->name)}),
+             getLevel(WARNING));
+        return;
+    }
+
+    emit(LogEvent("Player::processMove", "moving {}. New coordinates: {}",
+                  {stringField("direction", direction->name), pointField("position", newPosition.y, newPosition.x)}),
+         getLevel(INFO));
+
+    gameField_.clearPlayerPosition(position_);
+    position_       = newPosition;
+    result.position = position_;
+    gameField_.setPlayerPosition(position_);
+
+    if (position_ == GAME_END) {
+        result.isFinished = true;
+        emit(LogEvent("Player::play", "finished the game. Time = {} seconds.",
+                      {durationField("time", std::chrono::steady_clock::now() - startTime_)}),
+             INFO);
+    }
+}
+
+SimulationResult SimulationEngine::run(std::string_view moves) {
+    // смена уровня важности ('1') требует диалога, здесь выбор всегда отклоняется
+    SimulationResult result{position_, 0, 0, 0, position_ == GAME_END};
+    for (const char move : moves) {
+        if (move == ' ' || move == '\n' || move == '\r' || move == '\t') continue;
+        step(move, result);
+        if (result.isFinished) break;
+    }
+
+    return result;
+}
+
+const std::vector<SimulationEvent>& SimulationEngine::getEvents() const { return events_; }
+
+const GameField& SimulationEngine::getGameField() const { return gameField_; }
+
+Position SimulationEngine::getPosition() const { return position_; }
\ No newline at end of file
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <logger/logger.h>
+
+#include <chrono>
+#include <string_view>
+#include <vector>
+
+#include "game.h"
+#include "mazepack.h"
+#include "position.h"
+
+struct SimulationEvent {  // событие, которое записала бы игра
+    LogEvent event;
+    LogLevel logLevel;
+};
+
+struct SimulationResult {  // итог одного прогона
+    Position position;      // конечная позиция игрока
+    size_t   moveCount;     // сколько команд обработано
+    size_t   failedMoves;   // упор в стену или блок
+    size_t   invalidMoves;  // неизвестные команды
+    bool     isFinished;    // игрок дошел до финиша
+};
+
+class SimulationEngine {  // игра без консоли и задержек: команды берутся из строки, а не из std::cin
+   private:
+    GameField                             gameField_;     // игровое поле
+    Position                              position_;      // текущая позиция игрока
+    LogComponent*                         logComponent_;  // куда дублировать события, nullptr - никуда
+    bool                                  isRecording_;   // сохранять ли события для getEvents
+    std::vector<SimulationEvent>          events_;        // события с последнего restart
+    std::chrono::steady_clock::time_point startTime_;     // начало прохождения, для события о финише
+
+    void emit(const LogEvent& event, LogLevel logLevel);  // сохранить и отправить в журнал
+
+   public:
+    explicit SimulationEngine(LogComponent* logComponent = nullptr, bool isRecording = true);
+
+    int              generate(unsigned seed);      // новый лабиринт по зерну, возвращает число попыток
+    int              load(MazePool& pool);         // готовый лабиринт без генерации, возвращает число попыток
+    void             restart();                    // игрок снова на старте, лабиринт прежний
+    SimulationResult run(std::string_view moves);  // применить команды (пробелы пропускаются) до финиша
+    void step(char move, SimulationResult& result, int moveLevel = -1,
+              int chosenLevel = -1);  // одна команда; уровни -1 - по умолчанию и отказ в смене уровня
+
+    const std::vector<SimulationEvent>& getEvents() const;     // события, как их записала бы игра
+    const GameField&                    getGameField() const;  // текущее поле
+    Position                            getPosition() const;   // текущая позиция игрока
+};
\ No newline at end of file
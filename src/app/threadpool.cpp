@@ -0,0 +1,50 @@
+#include "threadpool.h"
+
+#include <stdexcept>
+
+ThreadPool::ThreadPool(size_t threadCount) : isStopped_(false) {
+    if (threadCount == 0) throw std::invalid_argument("Error: thread pool without threads!");
+
+    workers_.reserve(threadCount);
+    for (size_t i = 0; i != threadCount; ++i) workers_.emplace_back([this]() { work(); });
+}
+
+ThreadPool::~ThreadPool() { shutdown(); }
+
+void ThreadPool::work() {
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            condVar_.wait(lock, [this]() { return isStopped_ || !tasks_.empty(); });
+            if (tasks_.empty()) return;  // остановлен и очередь пуста
+
+            task = std::move(tasks_.front());
+            tasks_.pop();
+        }
+
+        task();
+    }
+}
+
+void ThreadPool::submit(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (isStopped_) throw std::runtime_error("Error: thread pool is stopped!");
+        tasks_.push(std::move(task));
+    }
+    condVar_.notify_one();
+}
+
+void ThreadPool::shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (isStopped_) return;
+        isStopped_ = true;
+    }
+    condVar_.notify_all();
+
+    for (auto& worker : workers_) worker.join();
+}
+
+size_t ThreadPool::getThreadCount() const { return workers_.size(); }
\ No newline at end of file
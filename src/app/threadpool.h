@@ -0,0 +1,27 @@
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+class ThreadPool {  // фиксированное число потоков и общая очередь задач
+   private:
+    std::vector<std::thread>          workers_;    // рабочие потоки
+    std::queue<std::function<void()>> tasks_;      // задачи в ожидании
+    std::mutex                        mutex_;      // для очереди задач
+    std::condition_variable           condVar_;    // будит рабочие потоки
+    bool                              isStopped_;  // новых задач не будет, дорабатываем очередь
+
+    void work();  // цикл рабочего потока
+
+   public:
+    explicit ThreadPool(size_t threadCount);
+    ~ThreadPool();
+
+    void   submit(std::function<void()> task);  // поставить задачу в очередь
+    void   shutdown();                          // выполнить оставшиеся задачи и остановить потоки
+    size_t getThreadCount() const;              // количество рабочих потоков
+};
\ No newline at end of file
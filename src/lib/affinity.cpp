@@ -0,0 +1,122 @@
+#include "affinity.h"
+
+#include <sched.h>
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+
+std::vector<int> parseCpuList(const std::string& list) {
+    // формат ядра (cpuset, sysfs): номера и диапазоны через запятую
+    std::vector<int> cpus;
+    size_t           begin = 0;
+    while (begin < list.size()) {
+        size_t end = list.find(',', begin);
+        if (end == std::string::npos) end = list.size();
+
+        const std::string part = list.substr(begin, end - begin);
+        const size_t      dash = part.find('-');
+        try {
+            size_t    used  = 0;
+            const int first = std::stoi(part, &used);
+            int       last  = first;
+            if (dash != std::string::npos) {
+                if (used != dash) throw std::invalid_argument(part);
+                last = std::stoi(part.substr(dash + 1), &used);
+                used += dash + 1;
+            }
+            if (used != part.size() || first < 0 || last < first || last >= CPU_SETSIZE)
+                throw std::invalid_argument(part);
+            for (int cpu = first; cpu <= last; ++cpu) cpus.push_back(cpu);
+        } catch (const std::logic_error&) {
+            throw std::invalid_argument("Invalid CPU list: " + list);
+        }
+        begin = end + 1;
+    }
+
+    if (cpus.empty() || list.back() == ',') throw std::invalid_argument("Invalid CPU list: " + list);
+    std::sort(cpus.begin(), cpus.end());
+    cpus.erase(std::unique(cpus.begin(), cpus.end()), cpus.end());
+    return cpus;
+}
+
+std::string formatCpuList(const std::vector<int>& cpus) {
+    std::string list;
+    for (size_t i = 0; i != cpus.size();) {
+        size_t last = i;
+        while (last + 1 != cpus.size() && cpus[last + 1] == cpus[last] + 1) ++last;
+
+        if (!list.empty()) list += ',';
+        list += std::to_string(cpus[i]);
+        if (last != i) list += '-' + std::to_string(cpus[last]);
+        i = last + 1;
+    }
+    return list;
+}
+
+void pinThread(pthread_t thread, const std::vector<int>& cpus) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (const int cpu : cpus) {
+        if (cpu < 0 || cpu >= CPU_SETSIZE) throw std::invalid_argument("Invalid CPU: " + std::to_string(cpu));
+        CPU_SET(cpu, &set);
+    }
+    if (pthread_setaffinity_np(thread, sizeof(set), &set) != 0)
+        throw std::runtime_error("Error: setting thread affinity!");
+}
+
+void pinCurrentThread(const std::vector<int>& cpus) { pinThread(pthread_self(), cpus); }
+
+std::vector<int> getThreadCpus() {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (pthread_getaffinity_np(pthread_self(), sizeof(set), &set) != 0)
+        throw std::runtime_error("Error: getting thread affinity!");
+
+    std::vector<int> cpus;
+    for (int cpu = 0; cpu != CPU_SETSIZE; ++cpu) {
+        if (CPU_ISSET(cpu, &set)) cpus.push_back(cpu);
+    }
+    return cpus;
+}
+
+int getCpuNode(int cpu) {
+    // у процессора в sysfs есть ссылка node<N> на его узел
+    std::error_code error;
+    for (const auto& entry :
+         std::filesystem::directory_iterator("/sys/devices/system/cpu/cpu" + std::to_string(cpu), error)) {
+        const std::string name = entry.path().filename().string();
+        if (name.size() > 4 && name.compare(0, 4, "node") == 0) return std::stoi(name.substr(4));
+    }
+    return 0;
+}
+
+int getCurrentNode() {
+    // getcpu читается через vDSO: это дешевле, чем запоминать узел, ведь поток без привязки переезжает
+    unsigned cpu = 0, node = 0;
+    if (getcpu(&cpu, &node) != 0) return 0;
+    return static_cast<int>(node);
+}
+
+int getNodeCount() {
+    std::ifstream possible("/sys/devices/system/node/possible");
+    std::string   list;
+    if (!std::getline(possible, list) || list.empty()) return 1;
+    try {
+        return parseCpuList(list).back() + 1;  // у узлов тот же формат списка
+    } catch (const std::invalid_argument&) {
+        return 1;
+    }
+}
+
+std::vector<int> getNodeCpus(int node) {
+    std::ifstream cpulist("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+    std::string   list;
+    if (!std::getline(cpulist, list) || list.empty()) return {};
+    try {
+        return parseCpuList(list);
+    } catch (const std::invalid_argument&) {
+        return {};
+    }
+}
\ No newline at end of file
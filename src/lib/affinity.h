@@ -0,0 +1,19 @@
+#pragma once
+
+#include <pthread.h>
+
+#include <string>
+#include <vector>
+
+// привязка потоков к процессорам и узлы NUMA (Linux: sched_setaffinity, getcpu и sysfs, без libnuma).
+// на машине с одним узлом всё работает так же, а узел любого процессора - 0
+
+std::vector<int> parseCpuList(const std::string& list);                      // "0-3,8" -> {0, 1, 2, 3, 8}
+std::string      formatCpuList(const std::vector<int>& cpus);                // {0, 1, 2, 3, 8} -> "0-3,8"
+void             pinThread(pthread_t thread, const std::vector<int>& cpus);  // поток - только на этих процессорах
+void             pinCurrentThread(const std::vector<int>& cpus);             // то же для вызывающего потока
+std::vector<int> getThreadCpus();                                            // где может выполняться вызывающий поток
+int              getCpuNode(int cpu);                                        // узел NUMA процессора, 0 - неизвестен
+int              getCurrentNode();                                           // узел, где поток сейчас (через vDSO)
+int              getNodeCount();                                             // узлов NUMA в системе, не меньше 1
+std::vector<int> getNodeCpus(int node);                                      // процессоры узла, пусто - если их нет
\ No newline at end of file
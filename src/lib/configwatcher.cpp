@@ -0,0 +1,209 @@
+#include "configwatcher.h"
+
+#include "logbackend.h"
+
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+
+namespace {
+
+constexpr size_t MAX_CONFIG_WATCHERS = 16;
+constexpr char   WAKE_RELOAD = 'r', WAKE_STOP = 's';
+
+struct SighupPipe {
+    std::atomic<int> fd{-1};  // конец канала для записи, -1 - свободно (0 - тоже дескриптор)
+};
+
+SighupPipe sighupPipes[MAX_CONFIG_WATCHERS];  // каналы наблюдателей, которые будит SIGHUP
+
+void sighupHandler(int) {
+    // в обработчике сигнала можно только write(2): будим потоки слежения
+    for (auto& pipe : sighupPipes) {
+        const int fd = pipe.fd.load(std::memory_order_relaxed);
+        if (fd >= 0) (void)!write(fd, &WAKE_RELOAD, 1);
+    }
+}
+
+std::string trim(const std::string& value) {
+    const size_t begin = value.find_first_not_of(" \t\r");
+    if (begin == std::string::npos) return "";
+    return value.substr(begin, value.find_last_not_of(" \t\r") - begin + 1);
+}
+
+LogLevel parseConfigLevel(const std::string& value) {
+    if (value == "INFO") return INFO;
+    if (value == "WARNING") return WARNING;
+    if (value == "ERROR") return ERROR;
+    throw std::invalid_argument("Invalid log level: " + value);
+}
+
+}  // namespace
+
+LogConfig parseLogConfig(const std::string& configFilename) {
+    // файл разбирается целиком до применения: с ошибкой не применяется ничего
+    std::ifstream configFile(configFilename);
+    if (!configFile.is_open()) throw std::runtime_error("Error: opening config file!");
+
+    LogConfig   config;
+    std::string line;
+    while (std::getline(configFile, line)) {
+        line = trim(line.substr(0, line.find('#')));
+        if (line.empty()) continue;
+
+        const size_t equal = line.find('=');
+        if (equal == std::string::npos) throw std::invalid_argument("Invalid config line: " + line);
+        const std::string key = trim(line.substr(0, equal)), value = trim(line.substr(equal + 1));
+
+        if (key == "level") {
+            config.logLevel = parseConfigLevel(value);
+            config.hasLevel = true;
+        } else if (key == "type") {
+            if (value != "SAFELY" && value != "FAST") throw std::invalid_argument("Invalid log type: " + value);
+            config.logType = value == "FAST" ? FAST : SAFELY;
+            config.hasType = true;
+        } else if (key == "format") {
+            if (value != "TEXT" && value != "JSON") throw std::invalid_argument("Invalid log format: " + value);
+            config.logFormat = value == "JSON" ? JSON : TEXT;
+            config.hasFormat = true;
+        } else if (key == "file") {
+            config.filename = value;
+        } else if (key.rfind("component.", 0) == 0 && key.size() > 10) {
+            config.componentLevels[key.substr(10)] =
+                value == "INHERIT" ? LogComponent::INHERIT_LEVEL : parseConfigLevel(value);
+        } else {
+            throw std::invalid_argument("Unknown config key: " + key);
+        }
+    }
+
+    return config;
+}
+
+void applyLogConfig(Logger& logger, const LogConfig& config) {
+    // применение не атомарно: журнал, слово настроек и уровни компонентов меняются по очереди,
+    // и параллельная запись может попасть в новый файл ещё со старым уровнем. каждый шаг согласован сам по себе.
+    // смена журнала может не удаться, поэтому она первая. тот же файл не переоткрываем:
+    // бэкенд у него общий, и переоткрытие задело бы все Logger этого файла
+    if (!config.filename.empty() &&
+        LogBackend::getRegistryKey(config.filename) != LogBackend::getRegistryKey(logger.getBackend()->getFilename()))
+        logger.reopen(config.filename);
+
+    // уровень, тип и формат - одним снимком: писатели не увидят наполовину примененные настройки
+    LogSettings settings = logger.getSettings();
+    if (config.hasType) settings.logType = config.logType;
+    if (config.hasFormat) settings.logFormat = config.logFormat;
+    if (config.hasLevel) settings.logLevel = config.logLevel;
+    if (config.hasType || config.hasFormat || config.hasLevel) logger.changeSettings(settings);
+
+    for (const auto& pair : config.componentLevels) {
+        LogComponent& component = logger.getComponent(pair.first);
+        if (pair.second == LogComponent::INHERIT_LEVEL)
+            component.resetLogLevel();
+        else
+            component.changeLogLevel(static_cast<LogLevel>(pair.second));
+    }
+}
+
+LogConfigWatcher::LogConfigWatcher(Logger& logger, const std::string& configFilename)
+    : logger_(logger),
+      configFilename_(std::filesystem::absolute(configFilename).string()),
+      inotifyFd_(-1),
+      wakePipe_{-1, -1},
+      running_(true),
+      reloadCount_(0) {
+    if (pipe2(wakePipe_, O_CLOEXEC | O_NONBLOCK) != 0) throw std::runtime_error("Error: creating config pipe!");
+
+    // следим за каталогом, а не за файлом: редакторы обычно сохраняют через переименование
+    const std::string directory = std::filesystem::path(configFilename_).parent_path().string();
+    inotifyFd_                  = inotify_init1(IN_CLOEXEC | IN_NONBLOCK);
+    if (inotifyFd_ < 0 || inotify_add_watch(inotifyFd_, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+        if (inotifyFd_ >= 0) close(inotifyFd_);
+        close(wakePipe_[0]);
+        close(wakePipe_[1]);
+        throw std::runtime_error("Error: watching config file!");
+    }
+
+    for (auto& pipe : sighupPipes) {
+        int expected = -1;
+        if (pipe.fd.compare_exchange_strong(expected, wakePipe_[1])) break;
+    }
+
+    reload();
+    watchThread_ = std::thread([this]() { watch(); });
+}
+
+LogConfigWatcher::~LogConfigWatcher() {
+    for (auto& pipe : sighupPipes) {
+        int expected = wakePipe_[1];
+        if (pipe.fd.compare_exchange_strong(expected, -1)) break;
+    }
+
+    running_.store(false);
+    (void)!write(wakePipe_[1], &WAKE_STOP, 1);
+    watchThread_.join();
+
+    close(inotifyFd_);
+    close(wakePipe_[0]);
+    close(wakePipe_[1]);
+}
+
+bool LogConfigWatcher::reload() {
+    try {
+        applyLogConfig(logger_, parseLogConfig(configFilename_));
+    } catch (const std::exception& e) {
+        logger_.log("LogConfigWatcher::reload | configuration rejected: " + std::string(e.what()), ERROR);
+        return false;
+    }
+
+    reloadCount_.fetch_add(1);
+    logger_.log("LogConfigWatcher::reload | configuration applied from " + configFilename_, WARNING);
+    return true;
+}
+
+void LogConfigWatcher::watch() {
+    const std::string configName = std::filesystem::path(configFilename_).filename().string();
+    pollfd            fds[2]     = {{inotifyFd_, POLLIN, 0}, {wakePipe_[0], POLLIN, 0}};
+
+    while (running_.load()) {
+        if (poll(fds, 2, -1) < 0) continue;  // EINTR
+
+        bool shouldReload = false;
+
+        if (fds[0].revents & POLLIN) {
+            alignas(inotify_event) char buffer[4096];
+            ssize_t                     size;
+            while ((size = read(inotifyFd_, buffer, sizeof(buffer))) > 0) {
+                for (char* current = buffer; current < buffer + size;) {
+                    const inotify_event* event = reinterpret_cast<const inotify_event*>(current);
+                    if (event->len != 0 && configName == event->name) shouldReload = true;
+                    current += sizeof(inotify_event) + event->len;
+                }
+            }
+        }
+
+        if (fds[1].revents & POLLIN) {
+            char command;
+            while (read(wakePipe_[0], &command, 1) == 1) {
+                if (command == WAKE_RELOAD) shouldReload = true;
+            }
+        }
+
+        if (shouldReload && running_.load()) reload();
+    }
+}
+
+size_t LogConfigWatcher::getReloadCount() const { return reloadCount_.load(); }
+
+void LogConfigWatcher::installSighupHandler() {
+    struct sigaction action {};
+    action.sa_handler = sighupHandler;
+    action.sa_flags   = SA_RESTART;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGHUP, &action, nullptr);
+}
\ No newline at end of file
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <atomic>
+#include <map>
+#include <string>
+#include <thread>
+
+#include "logger.h"
+
+// файл настроек журнала, строки вида ключ=значение, # - комментарий:
+//   level=WARNING
+//   type=FAST
+//   format=JSON
+//   file=other_log.txt
+//   component.GameField=INFO      (INHERIT - вернуть наследование)
+
+struct LogConfig {
+    bool                       hasLevel = false, hasType = false, hasFormat = false;
+    LogLevel                   logLevel  = INFO;
+    LogType                    logType   = SAFELY;
+    LogFormat                  logFormat = TEXT;
+    std::string                filename;         // пусто - журнал не меняется
+    std::map<std::string, int> componentLevels;  // LogLevel или LogComponent::INHERIT_LEVEL
+};
+
+LogConfig parseLogConfig(const std::string& configFilename);        // разбор файла, при ошибке - исключение
+void      applyLogConfig(Logger& logger, const LogConfig& config);  // к работающему журналу, по шагам (не атомарно)
+
+class LogConfigWatcher {  // перечитывает настройки при изменении файла (inotify) или по SIGHUP
+   private:
+    Logger&             logger_;          // журнал, который настраиваем
+    std::string         configFilename_;  // файл настроек
+    int                 inotifyFd_;       // слежение за каталогом файла настроек
+    int                 wakePipe_[2];     // SIGHUP и остановка будят поток через этот канал
+    std::atomic<bool>   running_;         // для остановки потока
+    std::atomic<size_t> reloadCount_;     // количество успешных применений
+    std::thread         watchThread_;     // поток слежения
+
+    void watch();  // ожидание событий и перечитывание настроек
+
+   public:
+    LogConfigWatcher(Logger& logger, const std::string& configFilename);
+    ~LogConfigWatcher();
+
+    bool        reload();                // перечитать сейчас, при ошибке остаются старые настройки
+    size_t      getReloadCount() const;  // сколько раз настройки были применены
+    static void installSighupHandler();  // SIGHUP -> перечитать настройки во всех наблюдателях
+};
\ No newline at end of file
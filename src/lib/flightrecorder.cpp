@@ -0,0 +1,344 @@
+#include "flightrecorder.h"
+
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+#include <mutex>
+
+// всё, что вызывается из обработчика сигнала, обходится без malloc, stdio и localtime:
+// только write(2), open(2) и арифметика над буфером на стеке
+
+namespace {
+
+constexpr size_t MAX_CRASH_RECORDERS = 16;  // сколько буферов одновременно сбрасывается при падении
+constexpr int    CRASH_SIGNALS[]     = {SIGSEGV, SIGABRT, SIGBUS, SIGFPE, SIGILL};
+
+std::atomic<FlightRecorder*> crashRecorders[MAX_CRASH_RECORDERS];  // зарегистрированные буферы
+
+class SignalSafeWriter {  // строка с ручным форматированием чисел: в буфер на стеке и в fd
+                          // или в чужой буфер фиксированного размера, где лишнее обрезается
+   private:
+    int    fd_;              // -1 - никуда не выводить
+    char*  buffer_;          // ownBuffer_ или чужой буфер
+    size_t capacity_;        // размер buffer_
+    size_t size_;            // сколько в нём занято
+    char   ownBuffer_[1024];
+
+   public:
+    explicit SignalSafeWriter(int fd) : fd_(fd), buffer_(ownBuffer_), capacity_(sizeof(ownBuffer_)), size_(0) {}
+    SignalSafeWriter(char* buffer, size_t capacity) : fd_(-1), buffer_(buffer), capacity_(capacity), size_(0) {}
+    ~SignalSafeWriter() { flush(); }
+
+    size_t getSize() const { return size_; }
+
+    void flush() {
+        if (fd_ < 0) return;
+        const char* current = buffer_;
+        while (size_ != 0) {
+            const ssize_t written = write(fd_, current, size_);
+            if (written < 0 && errno == EINTR) continue;
+            if (written <= 0) break;
+            current += written;
+            size_ -= static_cast<size_t>(written);
+        }
+        size_ = 0;
+    }
+
+    void append(char symbol) {
+        if (size_ == capacity_) {
+            if (fd_ < 0) return;
+            flush();
+        }
+        buffer_[size_++] = symbol;
+    }
+
+    void append(const char* text, size_t size) {
+        for (size_t i = 0; i != size; ++i) append(text[i]);
+    }
+
+    void append(const char* text) {
+        if (text == nullptr) return;
+        while (*text != '\0') append(*text++);
+    }
+
+    void appendNumber(int64_t value, int width = 0) {
+        char     digits[24];
+        int      count    = 0;
+        uint64_t absolute = value < 0 ? 0 - static_cast<uint64_t>(value) : static_cast<uint64_t>(value);
+        do {
+            digits[count++] = static_cast<char>('0' + absolute % 10);
+            absolute /= 10;
+        } while (absolute != 0);
+
+        if (value < 0) append('-');
+        for (int i = count; i < width; ++i) append('0');
+        while (count != 0) append(digits[--count]);
+    }
+
+    void appendFixed(double value) {  // шесть знаков после запятой, как у std::to_string
+        if (value != value) return append("nan");
+        if (value < 0) {
+            append('-');
+            value = -value;
+        }
+        if (value >= 9e18) return append("inf");
+
+        int64_t integer  = static_cast<int64_t>(value);
+        int64_t fraction = static_cast<int64_t>((value - static_cast<double>(integer)) * 1e6 + 0.5);
+        if (fraction >= 1000000) {
+            ++integer;
+            fraction -= 1000000;
+        }
+        appendNumber(integer);
+        append('.');
+        appendNumber(fraction, 6);
+    }
+
+    void appendTime(int64_t nanoseconds, long utcOffset) {  // [dd-mm-YYYY HH:MM:SS.nnnnnnnnn]
+        int64_t seconds = nanoseconds / 1000000000 + utcOffset;
+        int64_t days    = seconds / 86400;
+        int64_t rest    = seconds % 86400;
+        if (rest < 0) {
+            rest += 86400;
+            --days;
+        }
+
+        // перевод дней от эпохи в календарную дату (алгоритм civil_from_days)
+        const int64_t z     = days + 719468;
+        const int64_t era   = (z >= 0 ? z : z - 146096) / 146097;
+        const int64_t doe   = z - era * 146097;
+        const int64_t yoe   = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+        const int64_t doy   = doe - (365 * yoe + yoe / 4 - yoe / 100);
+        const int64_t mp    = (5 * doy + 2) / 153;
+        const int64_t day   = doy - (153 * mp + 2) / 5 + 1;
+        const int64_t month = mp < 10 ? mp + 3 : mp - 9;
+        const int64_t year  = yoe + era * 400 + (month <= 2 ? 1 : 0);
+
+        append('[');
+        appendNumber(day, 2);
+        append('-');
+        appendNumber(month, 2);
+        append('-');
+        appendNumber(year, 4);
+        append(' ');
+        appendNumber(rest / 3600, 2);
+        append(':');
+        appendNumber(rest / 60 % 60, 2);
+        append(':');
+        appendNumber(rest % 60, 2);
+        append('.');
+        appendNumber(nanoseconds % 1000000000, 9);
+        append(']');
+    }
+
+    void appendField(const LogField& field) {
+        switch (field.type) {
+            case LogField::INT:
+                appendNumber(field.intValue);
+                break;
+            case LogField::DOUBLE:
+                appendFixed(field.doubleValue);
+                break;
+            case LogField::CHAR:
+                append(field.charValue);
+                break;
+            case LogField::POINT:
+                appendNumber(field.pointValue[0]);
+                append(';');
+                appendNumber(field.pointValue[1]);
+                break;
+            case LogField::DURATION:
+                appendNumber(field.durationValue / 1000000000);
+                append('.');
+                appendNumber(field.durationValue % 1000000000 / 1000, 6);
+                break;
+            case LogField::STRING:
+                append(field.stringValue);
+                break;
+        }
+    }
+
+    void appendEvent(const LogEvent& event) {  // тот же вид, что у appendEventText
+        uint8_t next = 0;
+        append(event.name);
+        append(" | ");
+
+        for (const char* current = event.message; current != nullptr && *current != '\0'; ++current) {
+            if (current[0] == '{' && current[1] == '}' && next < event.fieldCount) {
+                appendField(event.fields[next++]);
+                ++current;
+            } else {
+                append(*current);
+            }
+        }
+
+        for (; next < event.fieldCount; ++next) {
+            append(' ');
+            append(event.fields[next].key);
+            append('=');
+            appendField(event.fields[next]);
+        }
+    }
+};
+
+const char* getFlightLevelName(LogLevel logLevel) {
+    switch (logLevel) {
+        case INFO:
+            return "INFO";
+        case WARNING:
+            return "WARNING";
+        case ERROR:
+            return "ERROR";
+        default:
+            return "UNKNOWN";
+    }
+}
+
+void crashSignalHandler(int signalNumber) {
+    for (auto& slot : crashRecorders) {
+        const FlightRecorder* recorder = slot.load(std::memory_order_acquire);
+        if (recorder != nullptr) recorder->dumpToFile();
+    }
+
+    // возвращаем стандартную обработку и доводим падение до конца (core dump и т.п.)
+    signal(signalNumber, SIG_DFL);
+    raise(signalNumber);
+}
+
+}  // namespace
+
+FlightRecorder::FlightRecorder(const std::string& dumpFilename, size_t capacity, const LogClock* clock)
+    : capacity_(1),
+      head_(0),
+      dumpFilename_(),
+      utcOffset_(0),
+      ownClock_(clock == nullptr ? std::make_unique<LogClock>(LOG_CLOCK_COARSE) : nullptr),
+      clock_(clock == nullptr ? ownClock_.get() : clock) {
+    while (capacity_ < capacity) capacity_ <<= 1;  // для деления по маске
+    records_ = std::make_unique<FlightRecord[]>(capacity_);
+
+    std::strncpy(dumpFilename_, dumpFilename.c_str(), sizeof(dumpFilename_) - 1);
+
+    // localtime нельзя звать из обработчика сигнала, поэтому смещение считаем заранее
+    std::time_t now = std::time(nullptr);
+    std::tm     local{};
+    if (localtime_r(&now, &local) != nullptr) utcOffset_ = local.tm_gmtoff;
+
+    for (auto& slot : crashRecorders) {
+        FlightRecorder* expected = nullptr;
+        if (slot.compare_exchange_strong(expected, this)) break;
+    }
+}
+
+FlightRecorder::~FlightRecorder() {
+    for (auto& slot : crashRecorders) {
+        FlightRecorder* expected = this;
+        if (slot.compare_exchange_strong(expected, nullptr)) break;
+    }
+}
+
+FlightRecord* FlightRecorder::reserve(LogLevel logLevel, uint64_t& ticket) noexcept {
+    // каждый производитель получает свой номер, ячейка = номер по модулю размера буфера.
+    // после переполнения кольца в ту же ячейку может прийти второй писатель: ячейку захватывает CAS по номеру,
+    // и запись отбрасывается, если ячейку ещё пишет прежний владелец (номер нечётный) или уже занял более новый
+    ticket                = head_.fetch_add(1, std::memory_order_relaxed);
+    FlightRecord& record  = records_[ticket & (capacity_ - 1)];
+    uint64_t      current = record.sequence.load(std::memory_order_relaxed);
+    do {
+        if ((current & 1) != 0 || current > ticket * 2) return nullptr;
+    } while (!record.sequence.compare_exchange_weak(current, ticket * 2 + 1, std::memory_order_relaxed));
+    std::atomic_thread_fence(std::memory_order_release);
+
+    record.ticks    = clock_->now();  // в настенное время - только при сбросе
+    record.logLevel = logLevel;
+
+    return &record;
+}
+
+void FlightRecorder::publish(FlightRecord& record, uint64_t ticket) noexcept {
+    record.sequence.store(ticket * 2 + 2, std::memory_order_release);
+}
+
+void FlightRecorder::record(std::string_view message, LogLevel logLevel) noexcept {
+    uint64_t      ticket;
+    FlightRecord* record = reserve(logLevel, ticket);
+    if (record == nullptr) return;
+
+    record->textSize = static_cast<uint16_t>(std::min(message.size(), FLIGHT_RECORD_TEXT_SIZE));
+    std::memcpy(record->text, message.data(), record->textSize);
+
+    publish(*record, ticket);
+}
+
+void FlightRecorder::record(const LogEvent& event, LogLevel logLevel) noexcept {
+    // событие форматируется сразу: его поля - указатели на строки вызывающего, к сбросу их может уже не быть
+    uint64_t      ticket;
+    FlightRecord* record = reserve(logLevel, ticket);
+    if (record == nullptr) return;
+
+    SignalSafeWriter writer(record->text, FLIGHT_RECORD_TEXT_SIZE);
+    writer.appendEvent(event);
+    record->textSize = static_cast<uint16_t>(writer.getSize());
+
+    publish(*record, ticket);
+}
+
+void FlightRecorder::dump(int fd) const noexcept {
+    // читаем по seqlock: копия ячейки годится, только если номер до и после копирования
+    // совпадает с ожидаемым. недописанные и перезаписанные ячейки пропускаются
+    const uint64_t head  = head_.load(std::memory_order_acquire);
+    const uint64_t first = head > capacity_ ? head - capacity_ : 0;
+
+    SignalSafeWriter writer(fd);
+    writer.append("--- flight recorder: last ");
+    writer.appendNumber(static_cast<int64_t>(head - first));
+    writer.append(" records ---\n");
+
+    for (uint64_t ticket = first; ticket != head; ++ticket) {
+        const FlightRecord& record   = records_[ticket & (capacity_ - 1)];
+        const uint64_t      expected = ticket * 2 + 2;
+        if (record.sequence.load(std::memory_order_acquire) != expected) continue;
+
+        uint64_t ticks    = record.ticks;
+        LogLevel logLevel = record.logLevel;
+        uint16_t textSize = std::min<uint16_t>(record.textSize, FLIGHT_RECORD_TEXT_SIZE);
+        char     text[FLIGHT_RECORD_TEXT_SIZE];
+        std::memcpy(text, record.text, textSize);
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (record.sequence.load(std::memory_order_relaxed) != expected) continue;
+
+        writer.appendTime(clock_->toWallTime(ticks), utcOffset_);
+        writer.append(" [");
+        writer.append(getFlightLevelName(logLevel));
+        writer.append("] ");
+        writer.append(text, textSize);
+        writer.append('\n');
+    }
+}
+
+bool FlightRecorder::dumpToFile() const noexcept {
+    const int fd = open(dumpFilename_, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) return false;
+
+    dump(fd);
+    close(fd);
+    return true;
+}
+
+const char* FlightRecorder::getDumpFilename() const { return dumpFilename_; }
+
+void FlightRecorder::installCrashHandler() {
+    static std::once_flag installed;
+    std::call_once(installed, []() {
+        struct sigaction action {};
+        action.sa_handler = crashSignalHandler;
+        sigemptyset(&action.sa_mask);
+        for (const int signalNumber : CRASH_SIGNALS) sigaction(signalNumber, &action, nullptr);
+    });
+}
\ No newline at end of file
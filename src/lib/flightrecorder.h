@@ -0,0 +1,46 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include "logger.h"
+
+constexpr size_t FLIGHT_RECORD_TEXT_SIZE = 232;  // длиннее сообщения и события обрезаются
+
+struct FlightRecord {  // ячейка кольцевого буфера, 256 байт
+    std::atomic<uint64_t> sequence;  // seqlock и владение: нечётное значение - запись ещё идёт
+    uint64_t              ticks;     // LogClock::now(), в настенное время переводится при сбросе
+    LogLevel              logLevel;  // уровень важности
+    uint16_t              textSize;  // длина текста
+    char                  text[FLIGHT_RECORD_TEXT_SIZE];  // сообщение или уже отформатированное событие
+};
+
+class FlightRecorder {  // последние N записей журнала в памяти независимо от уровня важности
+   private:
+    size_t                          capacity_;           // размер буфера (степень двойки)
+    std::unique_ptr<FlightRecord[]> records_;            // кольцевой буфер
+    std::atomic<uint64_t>           head_;               // номер следующей записи
+    char                            dumpFilename_[256];  // куда сбрасывать буфер при падении
+    long                            utcOffset_;          // смещение местного времени, запоминается заранее
+    std::unique_ptr<LogClock>       ownClock_;           // свои часы, если журнал не дал общие
+    const LogClock*                 clock_;              // часы для времени записей
+
+    FlightRecord* reserve(LogLevel logLevel, uint64_t& ticket) noexcept;    // захват ячейки, nullptr - занята
+    void          publish(FlightRecord& record, uint64_t ticket) noexcept;  // ячейка готова к чтению
+
+   public:
+    explicit FlightRecorder(const std::string& dumpFilename, size_t capacity = 4096,
+                            const LogClock* clock = nullptr);  // clock - часы журнала, nullptr - свои
+    ~FlightRecorder();
+
+    void        record(std::string_view message, LogLevel logLevel) noexcept;  // запомнить сообщение
+    void        record(const LogEvent& event, LogLevel logLevel) noexcept;     // запомнить событие
+    void        dump(int fd) const noexcept;  // вывод буфера, безопасен для обработчика сигнала
+    bool        dumpToFile() const noexcept;  // вывод в файл сброса, безопасен для обработчика сигнала
+    const char* getDumpFilename() const;      // имя файла сброса
+
+    static void installCrashHandler();  // SIGSEGV/SIGABRT/SIGBUS/SIGFPE/SIGILL -> сброс всех буферов
+};
\ No newline at end of file
@@ -0,0 +1,256 @@
+#include "logbackend.h"
+
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstring>
+#include <filesystem>
+#include <iomanip>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+
+std::mutex                                       registryMutex;    // реестр и смена его ключей
+std::condition_variable                          registryCondVar;  // бэкенд, отпущенный последним владельцем, ушел
+std::map<std::string, std::weak_ptr<LogBackend>> registry;         // бэкенды по каноническому пути
+
+std::shared_ptr<LogBackend> getRegistered(std::unique_lock<std::mutex>& lock, const std::string& key) {
+    // запись с истекшей ссылкой - бэкенд, чей release ещё не дописал индекс и не закрыл файл.
+    // новый бэкенд этого файла открываем только после него: иначе openIndex опишет те же байты второй раз.
+    // последняя ссылка уходит и без мьютекса реестра, поэтому живой бэкенд сразу захватываем
+    std::shared_ptr<LogBackend> backend;
+    registryCondVar.wait(lock, [&key, &backend]() {
+        auto it = registry.find(key);
+        return it == registry.end() || (backend = it->second.lock()) != nullptr;
+    });
+    return backend;  // nullptr - ключ свободен
+}
+
+}  // namespace
+
+std::shared_ptr<LogBackend> LogBackend::acquire(const std::string& filename) {
+    // создание - под мьютексом реестра: два Logger на новый файл не откроют его дважды.
+    // stale объявлен до блокировки и отпускается после неё: если ссылка на него последняя, release берет мьютекс
+    const std::string            key = getRegistryKey(filename);
+    std::shared_ptr<LogBackend>  stale;
+    std::unique_lock<std::mutex> lock(registryMutex);
+
+    // файл, удаленный или подмененный после открытия (std::remove, ротация снаружи), - уже другой журнал:
+    // старый бэкенд дописывает свой inode, а по пути открывается новый
+    stale = getRegistered(lock, key);
+    if (stale != nullptr) {
+        if (stale->isOpenAt(filename)) return stale;
+        stale->registryKey_.clear();
+        registry.erase(key);
+    }
+
+    std::shared_ptr<LogBackend> backend(new LogBackend(filename), &LogBackend::release);
+    backend->registryKey_ = key;
+    registry[key]         = backend;
+    return backend;
+}
+
+void LogBackend::release(LogBackend* backend) {
+    // ссылок уже нет, но ключ в реестре ещё этого бэкенда: индекс и файл закрываются под мьютексом реестра,
+    // и только потом ключ освобождается для нового бэкенда
+    {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        backend->closeIndexBlock(true);
+        backend->logFile_.close();
+        backend->indexFile_.close();
+        if (!backend->registryKey_.empty()) registry.erase(backend->registryKey_);
+    }
+    registryCondVar.notify_all();
+    delete backend;
+}
+
+std::string LogBackend::getRegistryKey(const std::string& filename) {
+    // файла может ещё не быть: существующая часть пути раскрывается полностью (с символическими ссылками)
+    return std::filesystem::weakly_canonical(std::filesystem::absolute(filename)).string();
+}
+
+LogBackend::LogBackend(const std::string& filename)
+    : filename_(filename), indexBlock_(), fileOffset_(0), device_(0), inode_(0), cachedSecond_(-1) {
+    // после проверки расширения открываем файл и
+    // удостоверяемся, что он открыт. если что-то не так, бросаем исключение
+    if (std::filesystem::path(filename_).extension() != ".txt")
+        throw std::runtime_error("Error: file has invalid extension!");
+
+    logFile_.open(filename_, std::ios::app);
+    validateIsFileOpen();
+    openIndex();
+}
+
+LogBackend::~LogBackend() {
+    closeIndexBlock(true);  // недописанный блок тоже должен попасть в индекс (после release блок уже пуст)
+    logFile_.close();
+    indexFile_.close();
+}
+
+std::string LogBackend::getFilename() const {
+    std::lock_guard<std::mutex> lock(mutex_);  // reopen меняет имя под этим же мьютексом
+    return filename_;
+}
+
+bool LogBackend::isOpenAt(const std::string& filename) const {
+    // под мьютексом реестра: устройство и inode меняет только reopen, и тоже под ним
+    struct stat fileStat {};
+    return stat(filename.c_str(), &fileStat) == 0 && static_cast<uint64_t>(fileStat.st_dev) == device_ &&
+           static_cast<uint64_t>(fileStat.st_ino) == inode_;
+}
+
+void LogBackend::validateIsFileOpen() const {
+    if (!logFile_.is_open()) throw std::runtime_error("Error: opening file!");
+}
+
+void LogBackend::validateFileWriteSuccess() const {
+    if (logFile_.fail()) throw std::runtime_error("Error: failed to write to file!");
+}
+
+void LogBackend::openIndex() {
+    // индекс действителен, только если он построен для этого же файла (устройство и inode)
+    // и не ссылается за конец журнала. иначе начинаем его заново.
+    // всё, что лежит в журнале без индекса, описываем одним блоком без сведений о времени и уровнях
+    struct stat logStat {};
+    if (stat(filename_.c_str(), &logStat) != 0) throw std::runtime_error("Error: opening file!");
+    fileOffset_ = static_cast<uint64_t>(logStat.st_size);
+    device_     = static_cast<uint64_t>(logStat.st_dev);
+    inode_      = static_cast<uint64_t>(logStat.st_ino);
+
+    const std::string indexFilename = getLogIndexFilename(filename_);
+    LogIndexHeader    header{};
+    std::memcpy(header.magic, LOG_INDEX_MAGIC, sizeof(header.magic));
+    header.version = LOG_INDEX_VERSION;
+    header.device  = device_;
+    header.inode   = inode_;
+
+    bool     isValid    = false;
+    uint64_t indexedEnd = 0;
+    size_t   entryCount = 0;
+    {
+        std::ifstream  indexIn(indexFilename, std::ios::binary);
+        LogIndexHeader stored{};
+        if (indexIn.read(reinterpret_cast<char*>(&stored), sizeof(stored)) &&
+            std::memcmp(stored.magic, header.magic, sizeof(header.magic)) == 0 && stored.version == header.version &&
+            stored.device == header.device && stored.inode == header.inode) {
+            indexIn.seekg(0, std::ios::end);
+            entryCount = (static_cast<size_t>(indexIn.tellg()) - sizeof(LogIndexHeader)) / sizeof(LogIndexEntry);
+            isValid    = true;
+
+            if (entryCount != 0) {
+                LogIndexEntry last{};
+                indexIn.seekg(sizeof(LogIndexHeader) + (entryCount - 1) * sizeof(LogIndexEntry));
+                indexIn.read(reinterpret_cast<char*>(&last), sizeof(last));
+                indexedEnd = last.offset + last.size;
+                isValid    = indexIn.good() && indexedEnd <= fileOffset_;
+            }
+        }
+    }
+
+    if (isValid) {
+        // обрезаем оборванную запись, если прошлый процесс упал посреди неё
+        std::filesystem::resize_file(indexFilename, sizeof(LogIndexHeader) + entryCount * sizeof(LogIndexEntry));
+        indexFile_.open(indexFilename, std::ios::binary | std::ios::app);
+    } else {
+        indexedEnd = 0;
+        indexFile_.open(indexFilename, std::ios::binary | std::ios::trunc);
+        indexFile_.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    }
+
+    if (!indexFile_.is_open()) throw std::runtime_error("Error: opening index file!");
+
+    while (indexedEnd < fileOffset_) {
+        const uint64_t size = std::min<uint64_t>(fileOffset_ - indexedEnd, UINT32_MAX);
+        LogIndexEntry  unindexed{indexedEnd, static_cast<uint32_t>(size), LOG_INDEX_ALL_LEVELS, 0, LOG_INDEX_MAX_TIME};
+        indexFile_.write(reinterpret_cast<const char*>(&unindexed), sizeof(unindexed));
+        indexedEnd += size;
+    }
+
+    indexFile_.flush();
+}
+
+void LogBackend::indexRecord(std::time_t time, LogLevel logLevel, size_t size, bool flush) {
+    // записи копятся в текущем блоке, пока он не станет достаточно большим
+    if (indexBlock_.size == 0) {
+        indexBlock_.offset    = fileOffset_;
+        indexBlock_.levelMask = 0;
+        indexBlock_.firstTime = indexBlock_.lastTime = time;
+    }
+
+    indexBlock_.size += static_cast<uint32_t>(size);
+    indexBlock_.levelMask |= 1u << logLevel;
+    if (time < indexBlock_.firstTime) indexBlock_.firstTime = time;
+    if (time > indexBlock_.lastTime) indexBlock_.lastTime = time;
+    fileOffset_ += size;
+
+    if (indexBlock_.size >= LOG_INDEX_BLOCK_SIZE) closeIndexBlock(flush);
+}
+
+void LogBackend::closeIndexBlock(bool flush) {
+    if (indexBlock_.size == 0) return;
+
+    indexFile_.write(reinterpret_cast<const char*>(&indexBlock_), sizeof(indexBlock_));
+    if (flush) indexFile_.flush();
+
+    indexBlock_.size = 0;
+}
+
+std::string LogBackend::getCurrentTime(std::time_t time) const {
+    // записываем в строковый поток и
+    // кладём время в формате день-месяц-год час-минута-секунда
+    std::stringstream timeStream;
+    timeStream << std::put_time(std::localtime(&time), "%d-%m-%Y %H:%M:%S");
+
+    return timeStream.str();
+}
+
+const std::string& LogBackend::getCachedTime(std::time_t time) {
+    if (time != cachedSecond_) {
+        cachedTime_   = getCurrentTime(time);
+        cachedSecond_ = time;
+    }
+    return cachedTime_;
+}
+
+void LogBackend::reopen(const std::string& newFilename, bool flush) {
+    // переключаются все Logger этого файла: дескриптор у них один.
+    // новый журнал открываем заранее: при ошибке продолжаем писать в старый
+    if (std::filesystem::path(newFilename).extension() != ".txt")
+        throw std::runtime_error("Error: file has invalid extension!");
+
+    std::ofstream newFile(newFilename, std::ios::app);
+    if (!newFile.is_open()) throw std::runtime_error("Error: opening file!");
+
+    // старый бэкенд нового пути сначала дописывает свой индекс; occupant, как и stale в acquire,
+    // отпускается уже после мьютекса реестра
+    const std::string            key = getRegistryKey(newFilename);
+    std::shared_ptr<LogBackend>  occupant;
+    std::unique_lock<std::mutex> registryLock(registryMutex);
+    occupant = getRegistered(registryLock, key);
+
+    // у файла уже есть свой бэкенд: второй дескриптор и второй писатель индекса испортили бы оба.
+    // бэкенд удаленного или подмененного файла путь не держит - как и в acquire
+    if (occupant != nullptr && occupant.get() != this) {
+        if (occupant->isOpenAt(newFilename)) throw std::runtime_error("Error: file is already open by another logger!");
+        occupant->registryKey_.clear();
+        registry.erase(key);
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    closeIndexBlock(flush);
+    logFile_.close();
+    indexFile_.close();
+
+    logFile_    = std::move(newFile);
+    filename_   = newFilename;
+    indexBlock_ = LogIndexEntry();
+    openIndex();
+
+    // в реестре бэкенд переезжает на новый путь
+    if (!registryKey_.empty()) registry.erase(registryKey_);
+    registry[key] = weak_from_this();
+    registryKey_  = key;
+}
\ No newline at end of file
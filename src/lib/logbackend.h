@@ -0,0 +1,56 @@
+#pragma once
+
+#include <ctime>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "logger.h"
+
+// файл журнала с индексом, общий для всех Logger, открытых на один и тот же файл.
+// реестр процесса выдает их по каноническому пути: "logs.txt" и "./dir/../logs.txt" - один бэкенд,
+// то есть один дескриптор, один буфер и один мьютекс, и строки разных Logger не перемешиваются внутри записи.
+// бэкенд живет, пока на него ссылается хотя бы один Logger: последний отпускает его через release
+
+class LogBackend : public std::enable_shared_from_this<LogBackend> {
+   private:
+    std::string               filename_;      // имя файла
+    std::string               registryKey_;   // канонический путь в реестре, пусто - бэкенд не в реестре
+    mutable std::mutex        mutex_;         // запись в файл и индекс от всех Logger, имя файла
+    std::ofstream             logFile_;       // журнал сообщений
+    std::ofstream             indexFile_;     // разреженный индекс журнала
+    LogIndexEntry             indexBlock_;    // текущий (ещё не записанный в индекс) блок
+    uint64_t                  fileOffset_;    // текущий размер журнала в байтах
+    uint64_t                  device_;        // устройство и inode открытого файла: тот ли это ещё файл
+    uint64_t                  inode_;         // по пути в реестре
+    std::string               batchBuffer_;   // строки пачки logBatch, память переиспользуется
+    std::vector<LogBatchLine> batchLines_;    // время, уровень и длина каждой строки пачки
+    std::time_t               cachedSecond_;  // секунда, для которой отформатировано cachedTime_
+    std::string               cachedTime_;    // календарь меняется раз в секунду, а не на запись
+
+    friend class Logger;
+
+    void validateIsFileOpen() const;        // условие, что файл открыт
+    void validateFileWriteSuccess() const;  // для обеспечения успешной записи в журнал
+    void openIndex();                       // открытие индекса и проверка, что он относится к журналу
+    void indexRecord(std::time_t time, LogLevel logLevel, size_t size,
+                     bool flush);         // учёт записи в текущем блоке; flush - сбросить закрытый блок
+    void closeIndexBlock(bool flush);     // запись текущего блока в индекс
+    std::string        getCurrentTime(std::time_t time) const;  // форматирование времени
+    const std::string& getCachedTime(std::time_t time);  // то же с кэшем на секунду (под mutex_)
+    void reopen(const std::string& newFilename, bool flush);  // переключиться на другой журнал (.txt)
+    bool isOpenAt(const std::string& filename) const;  // путь ведет к открытому файлу (под мьютексом реестра)
+
+    static void release(LogBackend* backend);  // удалитель из acquire: дописывает индекс и уходит из реестра
+
+   public:
+    static std::shared_ptr<LogBackend> acquire(const std::string& filename);  // из реестра или новый
+    static std::string getRegistryKey(const std::string& filename);  // канонический путь: ключ реестра
+
+    explicit LogBackend(const std::string& filename);  // открывает файл; в реестр его кладет acquire
+    ~LogBackend();                                     // дописывает индекс и закрывает файлы
+
+    std::string getFilename() const;  // файл журнала
+};
\ No newline at end of file
@@ -0,0 +1,132 @@
+#include "logclock.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#endif
+
+namespace {
+
+int64_t readClockNanoseconds(clockid_t clock) {
+    timespec time;
+    clock_gettime(clock, &time);
+    return static_cast<int64_t>(time.tv_sec) * 1000000000 + time.tv_nsec;
+}
+
+struct TscOrigin {      // начало отсчета наклона TSC, одно на процесс
+    uint64_t ticks;      // тики
+    int64_t  monotonic;  // CLOCK_MONOTONIC_RAW там же, наносекунды
+};
+
+const TscOrigin& getTscOrigin() {
+    // частота TSC заранее не известна: начало отсчета берется один раз, и первые часы процесса выжидают
+    // LOG_CLOCK_FIRST_CALIBRATION, чтобы наклон сразу мерился по отрезку не короче. остальные уже не ждут
+    static const TscOrigin origin = []() {
+        TscOrigin start{0, 0};
+#if defined(__x86_64__) || defined(__i386__)
+        const uint64_t before = __rdtsc();
+        start.monotonic       = readClockNanoseconds(CLOCK_MONOTONIC_RAW);
+        start.ticks           = before + (__rdtsc() - before) / 2;
+        while (readClockNanoseconds(CLOCK_MONOTONIC_RAW) - start.monotonic < LOG_CLOCK_FIRST_CALIBRATION) {
+        }
+#endif
+        return start;
+    }();
+    return origin;
+}
+
+}  // namespace
+
+LogClock::LogClock(LogClockSource source)
+    : source_(source == LOG_CLOCK_TSC && hasInvariantTsc() ? LOG_CLOCK_TSC : LOG_CLOCK_COARSE),
+      sequence_(0),
+      baseTicks_(0),
+      baseWallTime_(0),
+      nanosPerTick_(1),
+      firstTicks_(0),
+      firstMonotonic_(0) {
+    int64_t wallTime;
+    readAnchor(firstTicks_, wallTime, firstMonotonic_);
+    publish(firstTicks_, wallTime, 1);
+
+    // наклон TSC считается от общего для процесса начала отсчета, дальше он только уточняется
+    if (source_ == LOG_CLOCK_TSC) {
+        const TscOrigin& origin = getTscOrigin();
+        firstTicks_             = origin.ticks;
+        firstMonotonic_         = origin.monotonic;
+        calibrate(true);
+    }
+}
+
+void LogClock::readAnchor(uint64_t& ticks, int64_t& wallTime, int64_t& monotonic) const {
+    if (source_ == LOG_CLOCK_COARSE) {
+        ticks     = now();
+        wallTime  = readClockNanoseconds(CLOCK_REALTIME);
+        monotonic = static_cast<int64_t>(ticks);
+        return;
+    }
+
+    // тики до и после чтения часов ОС: точка привязки - середина
+    const uint64_t before = now();
+    wallTime              = readClockNanoseconds(CLOCK_REALTIME);
+    monotonic             = readClockNanoseconds(CLOCK_MONOTONIC_RAW);
+    ticks                 = before + (now() - before) / 2;
+}
+
+void LogClock::publish(uint64_t ticks, int64_t wallTime, double nanosPerTick) {
+    const uint64_t sequence = sequence_.load(std::memory_order_relaxed);
+    sequence_.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    baseTicks_.store(ticks, std::memory_order_relaxed);
+    baseWallTime_.store(wallTime, std::memory_order_relaxed);
+    nanosPerTick_.store(nanosPerTick, std::memory_order_relaxed);
+
+    sequence_.store(sequence + 2, std::memory_order_release);
+}
+
+void LogClock::calibrate(bool force) {
+    // привязка к CLOCK_REALTIME обновляется, чтобы подхватывать перевод часов и NTP,
+    // а наклон считается по CLOCK_MONOTONIC_RAW от самого начала, без подстройки частоты
+    const uint64_t base = baseTicks_.load(std::memory_order_relaxed);
+    if (!force && toNanoseconds(now() - base) < LOG_CLOCK_CALIBRATION_PERIOD) return;
+
+    uint64_t ticks;
+    int64_t  wallTime, monotonic;
+    readAnchor(ticks, wallTime, monotonic);
+
+    double nanosPerTick = 1;
+    if (source_ == LOG_CLOCK_TSC && ticks != firstTicks_)
+        nanosPerTick = static_cast<double>(monotonic - firstMonotonic_) / static_cast<double>(ticks - firstTicks_);
+    publish(ticks, wallTime, nanosPerTick);
+}
+
+int64_t LogClock::toWallTime(uint64_t ticks) const noexcept {
+    // чтение по seqlock: только атомарные загрузки, поэтому годится и для обработчика сигнала
+    while (true) {
+        const uint64_t sequence = sequence_.load(std::memory_order_acquire);
+        const uint64_t base     = baseTicks_.load(std::memory_order_relaxed);
+        const int64_t  wallTime = baseWallTime_.load(std::memory_order_relaxed);
+        const double   slope    = nanosPerTick_.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (sequence % 2 != 0 || sequence_.load(std::memory_order_relaxed) != sequence) continue;
+
+        // тики записи могут быть и раньше точки привязки
+        const int64_t delta = static_cast<int64_t>(ticks - base);
+        return wallTime + static_cast<int64_t>(static_cast<double>(delta) * slope);
+    }
+}
+
+int64_t LogClock::toNanoseconds(uint64_t ticks) const noexcept {
+    return static_cast<int64_t>(static_cast<double>(ticks) * nanosPerTick_.load(std::memory_order_relaxed));
+}
+
+LogClockSource LogClock::getSource() const { return source_; }
+
+bool LogClock::hasInvariantTsc() {
+#if defined(__x86_64__) || defined(__i386__)
+    unsigned eax, ebx, ecx, edx;
+    return __get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx) != 0 && (edx & (1u << 8)) != 0;
+#else
+    return false;
+#endif
+}
\ No newline at end of file
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <time.h>
+
+#include <atomic>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+// на горячем пути время записи - только сырые тики: инвариантный TSC (rdtsc) или CLOCK_MONOTONIC_COARSE.
+// в настенное время тики переводит поток записи по линейной привязке, которую он же периодически уточняет
+
+enum LogClockSource { LOG_CLOCK_TSC, LOG_CLOCK_COARSE };  // TSC - наносекундный порядок между потоками
+
+constexpr int64_t LOG_CLOCK_CALIBRATION_PERIOD = 1000000000;  // наносекунд между уточнениями привязки
+constexpr int64_t LOG_CLOCK_FIRST_CALIBRATION  = 1000000;     // сколько мерить частоту TSC, раз на процесс
+
+class LogClock {  // тики для производителей и их перевод в настенное время для потока записи
+   private:
+    LogClockSource        source_;          // TSC, только если процессор гарантирует постоянную частоту
+    std::atomic<uint64_t> sequence_;        // seqlock привязки: нечётное значение - идет обновление
+    std::atomic<uint64_t> baseTicks_;       // тики в точке привязки
+    std::atomic<int64_t>  baseWallTime_;    // CLOCK_REALTIME в точке привязки, наносекунды
+    std::atomic<double>   nanosPerTick_;    // наклон привязки
+    uint64_t              firstTicks_;      // начало отсчета для наклона (у TSC - общее): чем дальше, тем точнее
+    int64_t               firstMonotonic_;  // CLOCK_MONOTONIC_RAW там же, наносекунды
+
+    void readAnchor(uint64_t& ticks, int64_t& wallTime, int64_t& monotonic) const;  // тики и часы ОС разом
+    void publish(uint64_t ticks, int64_t wallTime, double nanosPerTick);           // новая привязка
+
+   public:
+    explicit LogClock(LogClockSource source = LOG_CLOCK_TSC);
+
+    uint64_t now() const {  // горячий путь: ни системных вызовов, ни перевода в календарь
+#if defined(__x86_64__) || defined(__i386__)
+        if (source_ == LOG_CLOCK_TSC) return __rdtsc();
+#endif
+        timespec time;
+        clock_gettime(CLOCK_MONOTONIC_COARSE, &time);
+        return static_cast<uint64_t>(time.tv_sec) * 1000000000 + static_cast<uint64_t>(time.tv_nsec);
+    }
+
+    void           calibrate(bool force = false);                 // уточнить привязку, если прошел период
+    int64_t        toWallTime(uint64_t ticks) const noexcept;     // CLOCK_REALTIME в наносекундах, можно в сигнале
+    int64_t        toNanoseconds(uint64_t ticks) const noexcept;  // длительность в тиках -> наносекунды
+    LogClockSource getSource() const;                             // фактический источник (без TSC - COARSE)
+    static bool    hasInvariantTsc();  // TSC не меняет частоту и идет во всех состояниях процессора
+};
\ No newline at end of file
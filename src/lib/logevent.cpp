@@ -0,0 +1,200 @@
+#include "logevent.h"
+
+#include <charconv>
+#include <stdexcept>
+
+LogField intField(const char* key, int64_t value) {
+    LogField field{};
+    field.key      = key;
+    field.type     = LogField::INT;
+    field.intValue = value;
+    return field;
+}
+
+LogField doubleField(const char* key, double value) {
+    LogField field{};
+    field.key         = key;
+    field.type        = LogField::DOUBLE;
+    field.doubleValue = value;
+    return field;
+}
+
+LogField charField(const char* key, char value) {
+    LogField field{};
+    field.key       = key;
+    field.type      = LogField::CHAR;
+    field.charValue = value;
+    return field;
+}
+
+LogField pointField(const char* key, int32_t first, int32_t second) {
+    LogField field{};
+    field.key           = key;
+    field.type          = LogField::POINT;
+    field.pointValue[0] = first;
+    field.pointValue[1] = second;
+    return field;
+}
+
+LogField durationField(const char* key, std::chrono::nanoseconds value) {
+    LogField field{};
+    field.key           = key;
+    field.type          = LogField::DURATION;
+    field.durationValue = value.count();
+    return field;
+}
+
+LogField stringField(const char* key, const char* value) {
+    LogField field{};
+    field.key         = key;
+    field.type        = LogField::STRING;
+    field.stringValue = value;
+    return field;
+}
+
+LogEvent::LogEvent() : name(nullptr), message(nullptr), fieldCount(0), fields() {}
+
+LogEvent::LogEvent(const char* name, const char* message, std::initializer_list<LogField> fields)
+    : name(name), message(message), fieldCount(0), fields() {
+    if (fields.size() > LOG_EVENT_MAX_FIELDS) throw std::invalid_argument("Error: too many event fields!");
+    for (const LogField& field : fields) this->fields[fieldCount++] = field;
+}
+
+namespace {
+
+template <typename T>
+void appendNumber(std::string& out, T value) {
+    char buffer[32];
+    out.append(buffer, std::to_chars(buffer, buffer + sizeof(buffer), value).ptr);
+}
+
+void appendFixed(std::string& out, double value) {
+    // тот же вид, что у std::to_string(double)
+    char buffer[64];
+    out.append(buffer, std::to_chars(buffer, buffer + sizeof(buffer), value, std::chars_format::fixed, 6).ptr);
+}
+
+void appendFieldText(std::string& out, const LogField& field) {
+    switch (field.type) {
+        case LogField::INT:
+            appendNumber(out, field.intValue);
+            break;
+        case LogField::DOUBLE:
+            appendFixed(out, field.doubleValue);
+            break;
+        case LogField::CHAR:
+            out += field.charValue;
+            break;
+        case LogField::POINT:
+            appendNumber(out, field.pointValue[0]);
+            out += ';';
+            appendNumber(out, field.pointValue[1]);
+            break;
+        case LogField::DURATION:
+            appendFixed(out, static_cast<double>(field.durationValue) / 1e9);
+            break;
+        case LogField::STRING:
+            out += field.stringValue != nullptr ? field.stringValue : "";
+            break;
+    }
+}
+
+void appendFieldJson(std::string& out, const LogField& field) {
+    switch (field.type) {
+        case LogField::INT:
+            appendNumber(out, field.intValue);
+            break;
+        case LogField::DOUBLE:
+            appendFixed(out, field.doubleValue);
+            break;
+        case LogField::CHAR:
+            appendJsonString(out, std::string_view(&field.charValue, 1));
+            break;
+        case LogField::POINT:
+            out += '[';
+            appendNumber(out, field.pointValue[0]);
+            out += ',';
+            appendNumber(out, field.pointValue[1]);
+            out += ']';
+            break;
+        case LogField::DURATION:
+            appendNumber(out, field.durationValue);
+            break;
+        case LogField::STRING:
+            appendJsonString(out, field.stringValue != nullptr ? field.stringValue : "");
+            break;
+    }
+}
+
+}  // namespace
+
+void appendEventText(std::string& out, const LogEvent& event) {
+    // {} в шаблоне заменяем полями по порядку, оставшиеся поля дописываем как key=value
+    uint8_t next = 0;
+    out += event.name != nullptr ? event.name : "";
+    out += " | ";
+
+    for (const char* current = event.message; current != nullptr && *current != '\0'; ++current) {
+        if (current[0] == '{' && current[1] == '}' && next < event.fieldCount) {
+            appendFieldText(out, event.fields[next++]);
+            ++current;
+        } else {
+            out += *current;
+        }
+    }
+
+    for (; next < event.fieldCount; ++next) {
+        out += ' ';
+        out += event.fields[next].key;
+        out += '=';
+        appendFieldText(out, event.fields[next]);
+    }
+}
+
+void appendEventJson(std::string& out, const LogEvent& event) {
+    out += "\"event\":";
+    appendJsonString(out, event.name != nullptr ? event.name : "");
+    out += ",\"message\":";
+    appendJsonString(out, event.message != nullptr ? event.message : "");
+    out += ",\"fields\":{";
+
+    for (uint8_t i = 0; i != event.fieldCount; ++i) {
+        if (i != 0) out += ',';
+        appendJsonString(out, event.fields[i].key);
+        out += ':';
+        appendFieldJson(out, event.fields[i]);
+    }
+
+    out += '}';
+}
+
+void appendJsonString(std::string& out, std::string_view value) {
+    static const char HEX[] = "0123456789abcdef";
+
+    out += '"';
+    for (const char symbol : value) {
+        switch (symbol) {
+            case '"':
+                out += "\\\"";
+                break;
+            case '\\':
+                out += "\\\\";
+                break;
+            case '\n':
+                out += "\\n";
+                break;
+            case '\t':
+                out += "\\t";
+                break;
+            default:
+                if (static_cast<unsigned char>(symbol) < 0x20) {
+                    out += "\\u00";
+                    out += HEX[(symbol >> 4) & 0xF];
+                    out += HEX[symbol & 0xF];
+                } else {
+                    out += symbol;
+                }
+        }
+    }
+    out += '"';
+}
\ No newline at end of file
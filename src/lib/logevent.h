@@ -0,0 +1,50 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <initializer_list>
+#include <string>
+#include <string_view>
+
+// структурированное событие: имя, шаблон сообщения и типизированные поля.
+// хранит только сырые значения, в текст или JSON превращается лишь при записи в журнал
+
+enum LogFormat { TEXT, JSON };  // формат строк журнала
+
+constexpr size_t LOG_EVENT_MAX_FIELDS = 4;
+
+struct LogField {
+    enum Type { INT, DOUBLE, CHAR, POINT, DURATION, STRING };
+
+    const char* key;  // имя поля (строковый литерал)
+    Type        type;
+    union {
+        int64_t     intValue;
+        double      doubleValue;
+        char        charValue;
+        int32_t     pointValue[2];
+        int64_t     durationValue;  // наносекунды
+        const char* stringValue;    // строка должна жить до записи (строковый литерал)
+    };
+};
+
+LogField intField(const char* key, int64_t value);
+LogField doubleField(const char* key, double value);
+LogField charField(const char* key, char value);
+LogField pointField(const char* key, int32_t first, int32_t second);  // в тексте выводится как first;second
+LogField durationField(const char* key, std::chrono::nanoseconds value);  // в тексте - секунды
+LogField stringField(const char* key, const char* value);
+
+struct LogEvent {
+    const char* name;        // имя события, например "Player::processMove"
+    const char* message;     // шаблон сообщения, {} заменяются значениями полей по порядку
+    uint8_t     fieldCount;  // количество заполненных полей
+    LogField    fields[LOG_EVENT_MAX_FIELDS];
+
+    LogEvent();
+    LogEvent(const char* name, const char* message, std::initializer_list<LogField> fields = {});
+};
+
+void appendEventText(std::string& out, const LogEvent& event);    // "name | message", лишние поля как key=value
+void appendEventJson(std::string& out, const LogEvent& event);    // "event":...,"message":...,"fields":{...}
+void appendJsonString(std::string& out, std::string_view value);  // строка в кавычках с экранированием
\ No newline at end of file
@@ -1,86 +1,341 @@
 #include "logger.h"
 
-#include <chrono>
-#include <filesystem>
-#include <iomanip>
+#include "flightrecorder.h"
+#include "logbackend.h"
+#include "sharedlog.h"
+
+#include <algorithm>
 #include <iostream>
-#include <sstream>
 #include <stdexcept>
 
 constexpr char SPACE = ' ', END = '\n';  // для удобства
 
-Logger::Logger(const std::string& filename, LogLevel logLevel, LogType logType)
-    : filename_(filename), logLevel_(logLevel), logType_(logType), logFile_(filename_, std::ios::app) {
-    validateFile();
-    // после инициализации всех полей нужно удостовериться,
-    // что файл соответствует требованиям.
-    // если что-то не так, программа завершается
-}
-
-void Logger::validateFileExtension() const {
-    std::filesystem::path filePath(filename_);
-    if (filePath.extension() != ".txt") throw std::runtime_error("Error: file has invalid extension!");
+Logger::Logger(const std::string& filename, LogLevel logLevel, LogType logType, LogFormat logFormat,
+               LogClockSource clockSource)
+    : backend_(LogBackend::acquire(filename)),
+      settings_(packSettings({logType, logFormat, logLevel})),
+      clock_(clockSource),
+      activeRecorder_(nullptr),
+      activeTracer_(nullptr),
+      activeSharedLog_(nullptr) {
+    // файл уже открыт и проверен бэкендом: его мог открыть и другой Logger
 }
 
-void Logger::validateIsFileOpen() const {
-    if (!logFile_.is_open()) throw std::runtime_error("Error: opening file!");
-}
+Logger::~Logger() = default;  // индекс допишет последний владелец бэкенда
 
-void Logger::validateFile() const {
-    validateFileExtension();
-    validateIsFileOpen();
-}
+namespace {
 
-void Logger::validateFileWriteSuccess() const {
-    if (logFile_.fail()) throw std::runtime_error("Error: failed to write to file!");
+std::time_t toSeconds(int64_t wallTime) {  // наносекунды -> секунды с округлением вниз
+    return static_cast<std::time_t>(wallTime >= 0 ? wallTime / 1000000000 : (wallTime + 1) / 1000000000 - 1);
 }
 
-std::string Logger::getCurrentTime() const {
-    // для получения текущего времени используем chrono
-    // записываем в строковый поток и
-    // кладём время в формате день-месяц-год час-минута-секунда
-    auto              now       = std::chrono::system_clock::now();
-    auto              in_time_t = std::chrono::system_clock::to_time_t(now);
-    std::stringstream timeStream;
-    timeStream << '[' << std::put_time(std::localtime(&in_time_t), "%d-%m-%Y %H:%M:%S") << ']';
-
-    return timeStream.str();
-}
+}  // namespace
 
 std::string Logger::getLogLevelString(LogLevel logLevel) const {
     // вспомогательный метод для получения времени, поскольку используем
     // перечисления
     switch (logLevel) {
         case INFO:
-            return "[INFO]";
+            return "INFO";
         case WARNING:
-            return "[WARNING]";
+            return "WARNING";
         case ERROR:
-            return "[ERROR]";
+            return "ERROR";
         default:
-            return "[UNKNOWN]";
+            return "UNKNOWN";
     }
 }
 
-void Logger::log(const std::string& message, LogLevel logLevel) {
-    if (logLevel < logLevel_ || message.empty()) return;  // сообщения с уровнем ниже не записываются
+void Logger::record(std::string_view message, LogLevel logLevel) {
+    FlightRecorder* recorder = activeRecorder_.load(std::memory_order_relaxed);
+    if (recorder != nullptr && !message.empty()) recorder->record(message, logLevel);
+}
+
+void Logger::record(const LogEvent& event, LogLevel logLevel) {
+    FlightRecorder* recorder = activeRecorder_.load(std::memory_order_relaxed);
+    if (recorder != nullptr) recorder->record(event, logLevel);
+}
+
+void Logger::write(const std::string& message, LogLevel logLevel) { writeRecord(logLevel, &message, nullptr); }
 
-    std::lock_guard<std::mutex> lock(logMutex_);  // предотвращаем гонку данных
-    validateIsFileOpen();
+void Logger::writeEvent(const LogEvent& event, LogLevel logLevel) { writeRecord(logLevel, nullptr, &event); }
 
-    // записываем сообщение в красивом формате
-    logFile_ << getCurrentTime() << SPACE << getLogLevelString(logLevel) << SPACE << message << END;
+void Logger::writeRecord(LogLevel logLevel, const std::string* message, const LogEvent* event) {
+    TraceSpan span(activeTracer_.load(std::memory_order_relaxed), "Logger::writeRecord");
 
-    if (logType_ == SAFELY) {
-        logFile_.flush();  // сбрасываем буффер
-        validateFileWriteSuccess();
+    // в общий журнал уходят только текст, уровень и тики - строку оформит сборщик, мьютекс не нужен.
+    // если кольцо заполнено, запись не теряется, а попадает в свой файл
+    SharedLogProducer* sharedLog = activeSharedLog_.load(std::memory_order_relaxed);
+    if (sharedLog != nullptr) {
+        std::string eventText;
+        if (event != nullptr) appendEventText(eventText, *event);
+        if (sharedLog->push(clock_.now(), logLevel, event != nullptr ? eventText : *message)) return;
+    }
+
+    LogBackend&                 backend = *backend_;
+    std::lock_guard<std::mutex> lock(backend.mutex_);  // предотвращаем гонку данных, в том числе с другими Logger
+    backend.validateIsFileOpen();
+
+    // время - по тикам часов журнала, календарь форматируется раз в секунду
+    const LogSettings settings = getSettings();
+    clock_.calibrate();
+    const std::time_t now = toSeconds(clock_.toWallTime(clock_.now()));
+    std::string       line;
+    appendRecord(line, backend.getCachedTime(now), logLevel, settings.logFormat, event == nullptr ? *message : "",
+                 event);
+    backend.logFile_ << line;
+
+    if (settings.logType == SAFELY) {
+        backend.logFile_.flush();  // сбрасываем буффер
+        backend.validateFileWriteSuccess();
     }  // для быстрой записи этого делать не будем
+
+    backend.indexRecord(now, logLevel, line.size(), settings.logType == SAFELY);
+}
+
+void Logger::appendRecord(std::string& out, const std::string& time, LogLevel logLevel, LogFormat logFormat,
+                          std::string_view message, const LogEvent* event) const {
+    // записываем сообщение в красивом формате: текстом или строкой JSON.
+    // части дописываются по одной, без временных строк: в пачке это ни одного выделения памяти на строку
+    if (logFormat == TEXT) {
+        out += '[';
+        out += time;
+        out += "] [";
+        out += getLogLevelString(logLevel);
+        out += ']';
+        out += SPACE;
+        if (event != nullptr)
+            appendEventText(out, *event);
+        else
+            out += message;
+    } else {
+        out += "{\"time\":\"";
+        out += time;
+        out += "\",\"level\":\"";
+        out += getLogLevelString(logLevel);
+        out += "\",";
+        if (event != nullptr) {
+            appendEventJson(out, *event);
+        } else {
+            out += "\"message\":";
+            appendJsonString(out, message);
+        }
+        out += '}';
+    }
+    out += END;
+}
+
+void Logger::logBatch(const LogRecord* records, size_t count, bool flush) {
+    // записи пишутся как есть: уровни и самописец уже проверил тот, кто их собрал (как LogComponent::write).
+    // мьютекс, проверка файла, уточнение часов и сброс - один раз на пачку,
+    // а строки собираются в один буфер и уходят в файл одной записью.
+    // тики записей переводятся в настенное время здесь, а не в потоках, которые их создали
+    if (count == 0) return;
+
+    TraceSpan span(activeTracer_.load(std::memory_order_relaxed), "Logger::logBatch", "records",
+                   static_cast<int64_t>(count));
+
+    // в общий журнал - пока кольцо принимает, остаток пачки - в свой файл
+    SharedLogProducer* sharedLog = activeSharedLog_.load(std::memory_order_relaxed);
+    if (sharedLog != nullptr) {
+        const uint64_t now = clock_.now();
+        std::string    eventText;
+        for (; count != 0; ++records, --count) {
+            std::string_view text = records->message;
+            if (records->event.name != nullptr) {
+                eventText.clear();
+                appendEventText(eventText, records->event);
+                text = eventText;
+            }
+            if (text.empty()) continue;
+            if (!sharedLog->push(records->ticks != 0 ? records->ticks : now, records->logLevel, text)) break;
+        }
+        if (count == 0) return;
+    }
+
+    // буфер пачки - у бэкенда: он один на файл, сколько бы Logger в него ни писали
+    LogBackend&                 backend = *backend_;
+    std::lock_guard<std::mutex> lock(backend.mutex_);
+    backend.validateIsFileOpen();
+
+    const LogSettings settings = getSettings();
+    clock_.calibrate();
+    const uint64_t now = clock_.now();
+
+    std::string&               batchBuffer = backend.batchBuffer_;
+    std::vector<LogBatchLine>& batchLines  = backend.batchLines_;
+    batchBuffer.clear();
+    batchLines.clear();
+    for (size_t i = 0; i != count; ++i) {
+        const LogRecord& record  = records[i];
+        const bool       isEvent = record.event.name != nullptr;
+        if (!isEvent && record.message.empty()) continue;
+
+        const std::time_t time   = toSeconds(clock_.toWallTime(record.ticks != 0 ? record.ticks : now));
+        const size_t      before = batchBuffer.size();
+        appendRecord(batchBuffer, backend.getCachedTime(time), record.logLevel, settings.logFormat, record.message,
+                     isEvent ? &record.event : nullptr);
+        batchLines.push_back({time, record.logLevel, batchBuffer.size() - before});
+    }
+
+    backend.logFile_.write(batchBuffer.data(), static_cast<std::streamsize>(batchBuffer.size()));
+    if (settings.logType == SAFELY || flush) {
+        backend.logFile_.flush();
+        backend.validateFileWriteSuccess();
+    }
+
+    // индекс - после записи строк, чтобы он не ссылался на то, чего ещё нет в файле
+    for (const auto& line : batchLines)
+        backend.indexRecord(line.time, line.logLevel, line.size, settings.logType == SAFELY);
+}
+
+void Logger::changeLogLevel(LogLevel newLogLevel) {
+    std::lock_guard<std::mutex> lock(settingsMutex_);
+
+    LogSettings settings = getSettings();
+    settings.logLevel    = newLogLevel;
+    publishSettings(settings);
+}
+
+void Logger::changeLogType(LogType newLogType) {
+    std::lock_guard<std::mutex> lock(settingsMutex_);
+
+    LogSettings settings = getSettings();
+    settings.logType     = newLogType;
+    publishSettings(settings);
+}
+
+LogType Logger::getLogType() const { return getSettings().logType; }
+
+void Logger::changeLogFormat(LogFormat newLogFormat) {
+    std::lock_guard<std::mutex> lock(settingsMutex_);
+
+    LogSettings settings = getSettings();
+    settings.logFormat   = newLogFormat;
+    publishSettings(settings);
 }
 
-void Logger::changeLogLevel(LogLevel newLogLevel) { logLevel_ = newLogLevel; }
+LogFormat Logger::getLogFormat() const { return getSettings().logFormat; }
+
+void Logger::changeSettings(const LogSettings& newSettings) {
+    std::lock_guard<std::mutex> lock(settingsMutex_);
+    publishSettings(newSettings);
+}
+
+void Logger::publishSettings(const LogSettings& newSettings) {
+    // весь снимок - одно атомарное слово: пишущие потоки видят либо старые настройки, либо новые целиком,
+    // никогда не ждут замены, и хранить старые снимки не нужно
+    settings_.store(packSettings(newSettings), std::memory_order_release);
+    refreshComponentLevels();  // компоненты без собственного уровня наследуют новый
+}
+
+LogSettings Logger::getSettings() const { return unpackSettings(settings_.load(std::memory_order_acquire)); }
+
+void Logger::reopen(const std::string& newFilename) {
+    backend_->reopen(newFilename, getLogType() == SAFELY);
+}
+
+LogBackend* Logger::getBackend() const { return backend_.get(); }
+
+void Logger::enableFlightRecorder(const std::string& dumpFilename, size_t capacity) {
+    std::lock_guard<std::mutex> lock(setupMutex_);
+    if (flightRecorder_ != nullptr) return;
+
+    flightRecorder_ = std::make_unique<FlightRecorder>(dumpFilename, capacity, &clock_);
+    FlightRecorder::installCrashHandler();
+    activeRecorder_.store(flightRecorder_.get(), std::memory_order_release);
+}
+
+FlightRecorder* Logger::getFlightRecorder() const { return activeRecorder_.load(std::memory_order_acquire); }
+
+const LogClock& Logger::getClock() const { return clock_; }
+
+Tracer* Logger::enableTracing(size_t capacity) {
+    std::lock_guard<std::mutex> lock(setupMutex_);
+    if (tracer_ == nullptr) {
+        tracer_ = std::make_unique<Tracer>(clock_, capacity);
+        activeTracer_.store(tracer_.get(), std::memory_order_release);
+    }
+    return tracer_.get();
+}
+
+Tracer* Logger::getTracer() const { return activeTracer_.load(std::memory_order_acquire); }
+
+void Logger::attachSharedLog(const std::string& name) {
+    std::lock_guard<std::mutex> lock(setupMutex_);
+    if (sharedLog_ != nullptr) throw std::runtime_error("Error: shared log is already attached!");
+
+    sharedLog_ = std::make_unique<SharedLogProducer>(name, clock_.getSource());
+    activeSharedLog_.store(sharedLog_.get(), std::memory_order_release);
+}
+
+SharedLogProducer* Logger::getSharedLog() const { return activeSharedLog_.load(std::memory_order_acquire); }
+
+LogComponent& Logger::getComponent(const std::string& name) {
+    std::lock_guard<std::mutex> lock(componentsMutex_);
+    return getComponentLocked(name);
+}
+
+LogComponent& Logger::getComponentLocked(const std::string& name) {
+    auto it = components_.find(name);
+    if (it != components_.end()) return *it->second;
+
+    // "Player.Move" - потомок "Player", родители создаются по необходимости
+    const size_t  dot    = name.rfind('.');
+    LogComponent* parent = (dot == std::string::npos) ? nullptr : &getComponentLocked(name.substr(0, dot));
+
+    auto          component = std::make_unique<LogComponent>(*this, parent, name);
+    LogComponent& result    = *component;
+    components_.emplace(name, std::move(component));
+
+    return result;
+}
+
+void Logger::refreshComponentLevels() {
+    // изменения уровней редкие, поэтому пересчитываем всё дерево разом:
+    // в std::map родитель всегда идёт раньше своих потомков ("Player" < "Player.Move")
+    std::lock_guard<std::mutex> lock(componentsMutex_);
+    for (auto& pair : components_) {
+        LogComponent& component = *pair.second;
+        const int     own       = component.logLevel_.load();
+
+        LogLevel effective;
+        if (own != LogComponent::INHERIT_LEVEL)
+            effective = static_cast<LogLevel>(own);
+        else if (component.parent_ != nullptr)
+            effective = component.parent_->effectiveLevel_.load();
+        else
+            effective = getLogLevel();
+
+        component.effectiveLevel_.store(effective, std::memory_order_relaxed);
+    }
+}
+
+LogComponent::LogComponent(Logger& logger, LogComponent* parent, const std::string& name)
+    : logger_(logger),
+      parent_(parent),
+      name_(name),
+      logLevel_(INHERIT_LEVEL),
+      effectiveLevel_(parent != nullptr ? parent->effectiveLevel_.load() : logger.getLogLevel()) {}
+
+void LogComponent::write(const std::string& message, LogLevel logLevel) {
+    if (!message.empty()) logger_.write(message, logLevel);
+}
+
+void LogComponent::writeEvent(const LogEvent& event, LogLevel logLevel) { logger_.writeEvent(event, logLevel); }
+
+void LogComponent::changeLogLevel(LogLevel newLogLevel) {
+    logLevel_.store(newLogLevel);
+    logger_.refreshComponentLevels();
+}
+
+void LogComponent::resetLogLevel() {
+    logLevel_.store(INHERIT_LEVEL);
+    logger_.refreshComponentLevels();
+}
 
-void Logger::changeLogType(LogType newLogType) { logType_ = newLogType; }
+LogLevel LogComponent::getLogLevel() const { return effectiveLevel_.load(); }
 
-LogLevel Logger::getLogLevel() const { return logLevel_; }
+const std::string& LogComponent::getName() const { return name_; }
 
-LogType Logger::getLogType() const { return logType_; }
\ No newline at end of file
+Tracer* LogComponent::getTracer() const { return logger_.getTracer(); }
\ No newline at end of file
@@ -1,33 +1,179 @@
 #pragma once
 
+#include <atomic>
+#include <ctime>
 #include <fstream>
+#include <map>
+#include <memory>
 #include <mutex>
 #include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "logclock.h"
+#include "logevent.h"
+#include "logindex.h"
+#include "tracer.h"
 
 enum LogLevel { INFO, WARNING, ERROR };  // перечисление для уровня важности
 enum LogType { SAFELY, FAST };  // безопасная и быстрая (данные могут потеряться) запись сообщений
 
-class Logger {
+struct LogRecord {  // запись для Logger::logBatch
+    std::string_view message;    // текст, должен жить до конца logBatch
+    LogEvent         event;      // структурированное событие (если event.name задано, message не используется)
+    LogLevel         logLevel;   // уровень важности
+    uint64_t         ticks = 0;  // LogClock::now() в момент события, 0 - время записи в файл
+};
+
+struct LogBatchLine {  // строка пачки logBatch, для индекса
+    std::time_t time;      // секунды
+    LogLevel    logLevel;  // уровень важности
+    size_t      size;      // длина в байтах
+};
+
+struct LogSettings {  // настройки записи, заменяются только целиком
+    LogType   logType;    // тип записи
+    LogFormat logFormat;  // формат строк журнала
+    LogLevel  logLevel;   // уровень важности по умолчанию
+};
+
+class Logger;
+class LogBackend;
+class FlightRecorder;
+class SharedLogProducer;
+
+class LogComponent {  // именованный дочерний логгер ("APP", "Player", "Player.Move"), пишет в общий журнал
+   private:
+    Logger&               logger_;          // общий журнал
+    LogComponent*         parent_;          // родитель по имени, nullptr - уровень наследуется от Logger
+    std::string           name_;            // полное имя компонента
+    std::atomic<int>      logLevel_;        // собственный уровень важности или INHERIT_LEVEL
+    std::atomic<LogLevel> effectiveLevel_;  // итоговый уровень, пересчитывается при любом изменении
+
+    friend class Logger;
+
+   public:
+    static constexpr int INHERIT_LEVEL = -1;
+
+    LogComponent(Logger& logger, LogComponent* parent, const std::string& name);
+
+    bool isEnabled(LogLevel logLevel) const {  // проверка на горячем пути - одно атомарное чтение
+        return logLevel >= effectiveLevel_.load(std::memory_order_relaxed);
+    }
+    inline void log(const std::string& message, LogLevel logLevel = INFO);  // записать сообщение в журнал
+    inline void logEvent(const LogEvent& event, LogLevel logLevel = INFO);  // записать структурированное событие
+    inline void record(std::string_view message, LogLevel logLevel);        // только в бортовой самописец
+    inline void record(const LogEvent& event, LogLevel logLevel);           // только в бортовой самописец
+    void write(const std::string& message, LogLevel logLevel);  // в журнал без проверки уровня и самописца
+    void writeEvent(const LogEvent& event, LogLevel logLevel);  // (для очередей, где всё сделал производитель)
+    void changeLogLevel(LogLevel newLogLevel);  // задать собственный уровень важности
+    void resetLogLevel();                       // вернуться к уровню родителя
+    LogLevel           getLogLevel() const;     // итоговый уровень важности
+    const std::string& getName() const;         // полное имя компонента
+    Tracer*            getTracer() const;       // трассировщик журнала или nullptr
+};
+
+class Logger {  // легкий фасад: уровень, настройки и компоненты свои, а файл - общий бэкенд (logbackend.h)
    private:
-    std::string   filename_;  // имя файла
-    LogLevel      logLevel_;  // уровень важности
-    LogType       logType_;   // тип записи
-    std::mutex    logMutex_;  // мьютекс для обеспечения потокобезопасности
-    std::ofstream logFile_;   // журнал сообщений
-
-    void validateFileExtension() const;     // условие, что файл формата .txt
-    void validateIsFileOpen() const;        // условие, что файл открыт
-    void validateFile() const;              // для полной валидации файла
-    void validateFileWriteSuccess() const;  // для обеспечения успешной записи в журнал
-    std::string getCurrentTime() const;     // получение текущего времени
+    std::shared_ptr<LogBackend>     backend_;     // файл, индекс и буфер, общие для всех Logger этого файла
+    std::atomic<uint32_t>           settings_;    // снимок настроек одним словом: уровень, тип и формат (packSettings)
+    std::mutex                      setupMutex_;  // включение самописца, трассировки и общего журнала
+    LogClock                        clock_;       // тики производителей и их перевод в настенное время
+
+    std::mutex                                           componentsMutex_;  // для реестра компонентов
+    std::map<std::string, std::unique_ptr<LogComponent>> components_;       // компоненты по полному имени
+
+    std::mutex settingsMutex_;  // для замены снимка настроек
+
+    std::unique_ptr<FlightRecorder> flightRecorder_;  // бортовой самописец последних записей
+    std::atomic<FlightRecorder*>    activeRecorder_;  // он же для горячего пути, nullptr - выключен
+    std::unique_ptr<Tracer>         tracer_;          // трассировка отрезков времени
+    std::atomic<Tracer*>            activeTracer_;    // она же для горячего пути, nullptr - выключена
+
+    std::unique_ptr<SharedLogProducer> sharedLog_;        // кольцо процесса в общем журнале
+    std::atomic<SharedLogProducer*>    activeSharedLog_;  // оно же для горячего пути, nullptr - свой файл
+
+    friend class LogComponent;
+
     std::string getLogLevelString(LogLevel logLevel) const;  // получение уровня важности (строка)
+    void record(std::string_view message, LogLevel logLevel);  // в самописец, если он включен
+    void record(const LogEvent& event, LogLevel logLevel);     // (вне заголовка: FlightRecorder там неполный)
+    void write(const std::string& message, LogLevel logLevel);  // запись без проверки уровня
+    void writeEvent(const LogEvent& event, LogLevel logLevel);  // запись события без проверки уровня
+    void writeRecord(LogLevel logLevel, const std::string* message,
+                     const LogEvent* event);  // форматирование и запись одной строки журнала
+    void appendRecord(std::string& out, const std::string& time, LogLevel logLevel, LogFormat logFormat,
+                      std::string_view message, const LogEvent* event) const;  // строка журнала в out
+    LogComponent& getComponentLocked(const std::string& name);  // поиск или создание компонента
+    void          refreshComponentLevels();                     // пересчёт итоговых уровней компонентов
+    void publishSettings(const LogSettings& newSettings);  // новый снимок настроек (под settingsMutex_)
+    static uint32_t packSettings(const LogSettings& settings) {  // уровень - в младшем байте, для isEnabled
+        return static_cast<uint32_t>(settings.logLevel) | static_cast<uint32_t>(settings.logType) << 8 |
+               static_cast<uint32_t>(settings.logFormat) << 16;
+    }
+    static LogSettings unpackSettings(uint32_t packed) {  // слово -> снимок настроек
+        return {static_cast<LogType>(packed >> 8 & 0xFF), static_cast<LogFormat>(packed >> 16 & 0xFF),
+                static_cast<LogLevel>(packed & 0xFF)};
+    }
 
    public:
-    explicit Logger(const std::string& filename, LogLevel logLevel = INFO, LogType logType = SAFELY);
+    explicit Logger(const std::string& filename, LogLevel logLevel = INFO, LogType logType = SAFELY,
+                    LogFormat logFormat = TEXT, LogClockSource clockSource = LOG_CLOCK_TSC);
+    ~Logger();
 
-    void log(const std::string& message, LogLevel logLevel = INFO);  // записать сообщение в журнал
+    bool isEnabled(LogLevel logLevel) const {  // проверка уровня прямо в месте вызова, без перехода в библиотеку
+        return logLevel >= static_cast<LogLevel>(settings_.load(std::memory_order_relaxed) & 0xFF);
+    }
+    void log(const std::string& message, LogLevel logLevel = INFO) {  // записать сообщение в журнал
+        // самописец хранит всё подряд, независимо от уровня; сообщения с уровнем ниже не записываются
+        if (activeRecorder_.load(std::memory_order_relaxed) != nullptr) record(message, logLevel);
+        if (isEnabled(logLevel) && !message.empty()) write(message, logLevel);
+    }
+    void logEvent(const LogEvent& event, LogLevel logLevel = INFO) {  // записать структурированное событие
+        // отфильтрованное событие так и не превращается в строку
+        if (activeRecorder_.load(std::memory_order_relaxed) != nullptr) record(event, logLevel);
+        if (isEnabled(logLevel)) writeEvent(event, logLevel);
+    }
+    void logBatch(const LogRecord* records, size_t count,
+                  bool flush = false);  // пачка одной записью в файл, без фильтрации; flush - сбросить и при FAST
     void changeLogLevel(LogLevel newLogLevel);  // поменять уровень важности по умолчанию
     void     changeLogType(LogType newLogType);  // поменять тип записи по умолчанию
-    LogLevel getLogLevel() const;                // получение уровня важности
+    LogLevel getLogLevel() const { return unpackSettings(settings_.load()).logLevel; }  // получение уровня важности
     LogType  getLogType() const;                 // получение типа записи
-};
\ No newline at end of file
+    void      changeLogFormat(LogFormat newLogFormat);  // поменять формат строк журнала
+    LogFormat getLogFormat() const;                     // получение формата строк журнала
+    void        changeSettings(const LogSettings& newSettings);  // атомарно заменить тип, формат и уровень
+    LogSettings getSettings() const;                             // текущий снимок настроек
+    void        reopen(const std::string& newFilename);  // переключить журнал (.txt) - для всех Logger этого файла
+    LogBackend* getBackend() const;                      // общий файл журнала
+    LogComponent& getComponent(const std::string& name);  // дочерний логгер, иерархия задаётся точками
+    void enableFlightRecorder(const std::string& dumpFilename,
+                              size_t capacity = 4096);  // хранить последние записи и сбрасывать их при падении
+    FlightRecorder* getFlightRecorder() const;          // самописец или nullptr
+    const LogClock& getClock() const;                   // часы для LogRecord::ticks
+    Tracer* enableTracing(size_t capacity = TRACE_BUFFER_CAPACITY);  // включить трассировку (событий на поток)
+    Tracer* getTracer() const;                          // трассировщик или nullptr
+    void attachSharedLog(const std::string& name);  // писать в общий журнал сборщика (shm), а не в свой файл
+    SharedLogProducer* getSharedLog() const;        // кольцо в общем журнале или nullptr
+};
+
+// у компонента горячий путь тоже в заголовке: самописец и уровень проверяются в месте вызова,
+// в библиотеку уходит только принятая запись
+void LogComponent::log(const std::string& message, LogLevel logLevel) {
+    record(message, logLevel);
+    if (isEnabled(logLevel) && !message.empty()) logger_.write(message, logLevel);
+}
+
+void LogComponent::logEvent(const LogEvent& event, LogLevel logLevel) {
+    record(event, logLevel);
+    if (isEnabled(logLevel)) logger_.writeEvent(event, logLevel);
+}
+
+void LogComponent::record(std::string_view message, LogLevel logLevel) {
+    if (logger_.activeRecorder_.load(std::memory_order_relaxed) != nullptr) logger_.record(message, logLevel);
+}
+
+void LogComponent::record(const LogEvent& event, LogLevel logLevel) {
+    if (logger_.activeRecorder_.load(std::memory_order_relaxed) != nullptr) logger_.record(event, logLevel);
+}
\ No newline at end of file
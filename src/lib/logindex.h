@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+// разреженный индекс журнала: рядом с журналом лежит файл <журнал>.idx
+// в нём заголовок и записи фиксированного размера, каждая описывает блок журнала:
+// смещение, размер, диапазон времени и маску встретившихся уровней важности
+
+constexpr char     LOG_INDEX_MAGIC[4]   = {'L', 'G', 'I', 'X'};
+constexpr uint32_t LOG_INDEX_VERSION    = 1;
+constexpr uint32_t LOG_INDEX_BLOCK_SIZE = 64 * 1024;   // после стольких байт блок закрывается
+constexpr uint32_t LOG_INDEX_ALL_LEVELS = 0xFFFFFFFF;  // блок без сведений об уровнях
+constexpr int64_t  LOG_INDEX_MAX_TIME   = INT64_MAX;   // блок без сведений о времени
+
+struct LogIndexHeader {
+    char     magic[4];
+    uint32_t version;
+    uint64_t device, inode;  // идентичность журнала: пересозданный журнал делает индекс недействительным
+};
+
+struct LogIndexEntry {
+    uint64_t offset;               // смещение блока в журнале
+    uint32_t size;                 // размер блока в байтах
+    uint32_t levelMask;            // бит (1 << LogLevel) для каждого уровня в блоке
+    int64_t  firstTime, lastTime;  // диапазон времени записей блока (секунды)
+};
+
+inline std::string getLogIndexFilename(const std::string& logFilename) { return logFilename + ".idx"; }
\ No newline at end of file
@@ -0,0 +1,218 @@
+#include "reader.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+constexpr size_t LOG_TIME_SIZE         = 21;  // "[dd-mm-YYYY HH:MM:SS]"
+constexpr size_t LOG_JSON_TIME_OFFSET  = 9;   // {"time":"
+constexpr size_t LOG_JSON_LEVEL_OFFSET = 39;  // {"time":"dd-mm-YYYY HH:MM:SS","level":"
+
+std::time_t parseLogTime(std::string_view time) {
+    if (!time.empty() && time.front() == '[') time.remove_prefix(1);
+    if (time.size() < LOG_TIME_SIZE - 2) return -1;
+
+    // разбираем вручную: формат фиксированный, а std::get_time заметно медленнее
+    auto number = [&](size_t pos, size_t size) -> int {
+        int value = 0;
+        for (size_t i = pos; i != pos + size; ++i) {
+            if (time[i] < '0' || time[i] > '9') return -1;
+            value = value * 10 + (time[i] - '0');
+        }
+        return value;
+    };
+
+    std::tm tm{};
+    tm.tm_mday  = number(0, 2);
+    tm.tm_mon   = number(3, 2) - 1;
+    tm.tm_year  = number(6, 4) - 1900;
+    tm.tm_hour  = number(11, 2);
+    tm.tm_min   = number(14, 2);
+    tm.tm_sec   = number(17, 2);
+    tm.tm_isdst = -1;  // журнал пишется в местном времени
+
+    if (tm.tm_mday < 0 || tm.tm_mon < 0 || tm.tm_year < 0 || tm.tm_hour < 0 || tm.tm_min < 0 || tm.tm_sec < 0)
+        return -1;
+
+    return std::mktime(&tm);
+}
+
+const char* findSubstring(const char* begin, const char* end, std::string_view needle) {
+    // сравниваем сразу 16 позиций по первому и последнему символу образца,
+    // полное сравнение делаем только для кандидатов
+    const size_t size = needle.size();
+    if (size == 0) return begin;
+    if (static_cast<size_t>(end - begin) < size) return nullptr;
+    if (size == 1) return static_cast<const char*>(std::memchr(begin, needle.front(), end - begin));
+
+    const char* current = begin;
+    const char* limit   = end - size + 1;  // последняя возможная позиция начала совпадения + 1
+
+#if defined(__SSE2__)
+    const __m128i first = _mm_set1_epi8(needle.front());
+    const __m128i last  = _mm_set1_epi8(needle.back());
+
+    for (; current + 16 <= limit; current += 16) {
+        const __m128i blockFirst = _mm_loadu_si128(reinterpret_cast<const __m128i*>(current));
+        const __m128i blockLast  = _mm_loadu_si128(reinterpret_cast<const __m128i*>(current + size - 1));
+        unsigned      mask =
+            _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(first, blockFirst), _mm_cmpeq_epi8(last, blockLast)));
+
+        while (mask != 0) {
+            const int bit = __builtin_ctz(mask);
+            if (std::memcmp(current + bit + 1, needle.data() + 1, size - 2) == 0) return current + bit;
+            mask &= mask - 1;
+        }
+    }
+#endif
+
+    for (; current < limit; ++current) {
+        if (*current == needle.front() && std::memcmp(current, needle.data(), size) == 0) return current;
+    }
+
+    return nullptr;
+}
+
+LogReader::LogReader(const std::string& filename) : filename_(filename) {
+    struct stat logStat {};
+    if (stat(filename_.c_str(), &logStat) != 0) throw std::runtime_error("Error: opening file!");
+
+    const uint64_t fileSize = static_cast<uint64_t>(logStat.st_size);
+    loadIndex(fileSize, static_cast<uint64_t>(logStat.st_dev), static_cast<uint64_t>(logStat.st_ino));
+
+    // всё, что записано после последнего блока индекса (или журнал без индекса), читаем целиком
+    uint64_t indexedEnd = blocks_.empty() ? 0 : blocks_.back().offset + blocks_.back().size;
+    while (indexedEnd < fileSize) {
+        const uint64_t size = std::min<uint64_t>(fileSize - indexedEnd, UINT32_MAX);
+        blocks_.push_back({indexedEnd, static_cast<uint32_t>(size), LOG_INDEX_ALL_LEVELS, 0, LOG_INDEX_MAX_TIME});
+        indexedEnd += size;
+    }
+}
+
+void LogReader::loadIndex(uint64_t fileSize, uint64_t device, uint64_t inode) {
+    std::ifstream  indexIn(getLogIndexFilename(filename_), std::ios::binary);
+    LogIndexHeader header{};
+    if (!indexIn.read(reinterpret_cast<char*>(&header), sizeof(header))) return;
+    if (std::memcmp(header.magic, LOG_INDEX_MAGIC, sizeof(header.magic)) != 0 || header.version != LOG_INDEX_VERSION ||
+        header.device != device || header.inode != inode)
+        return;
+
+    // в FAST режиме индекс может опережать то, что реально дошло до журнала
+    LogIndexEntry entry{};
+    while (indexIn.read(reinterpret_cast<char*>(&entry), sizeof(entry))) {
+        if (entry.offset + entry.size > fileSize) break;
+        blocks_.push_back(entry);
+    }
+}
+
+bool LogReader::isBlockRelevant(const LogIndexEntry& block, const LogQuery& query) const {
+    return block.size != 0 && (block.levelMask & query.levelMask) != 0 && block.lastTime >= query.from &&
+           block.firstTime <= query.to;
+}
+
+size_t LogReader::query(const LogQuery& query, const std::function<void(std::string_view)>& onMatch) const {
+    const int fd = open(filename_.c_str(), O_RDONLY);
+    if (fd < 0) throw std::runtime_error("Error: opening file!");
+
+    const uint64_t pageSize = static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+    size_t         matched  = 0;
+
+    // кэш разбора времени: в соседних записях оно почти всегда одинаковое
+    std::string lastTimeString;
+    std::time_t lastTime = -1;
+
+    for (const LogIndexEntry& block : blocks_) {
+        if (!isBlockRelevant(block, query)) continue;
+
+        // отображаем в память только нужный блок (смещение выравниваем по странице)
+        const uint64_t alignedOffset = block.offset - block.offset % pageSize;
+        const size_t   mappedSize    = static_cast<size_t>(block.offset - alignedOffset + block.size);
+        void* mapped = mmap(nullptr, mappedSize, PROT_READ, MAP_PRIVATE, fd, static_cast<off_t>(alignedOffset));
+        if (mapped == MAP_FAILED) {
+            close(fd);
+            throw std::runtime_error("Error: failed to map log block!");
+        }
+        madvise(mapped, mappedSize, MADV_SEQUENTIAL);
+
+        const char* begin = static_cast<const char*>(mapped) + (block.offset - alignedOffset);
+        const char* end   = begin + block.size;
+
+        // блок целиком внутри диапазона времени и уровней - записи можно не разбирать
+        const bool checkTime  = block.firstTime < query.from || block.lastTime > query.to;
+        const bool checkLevel = (block.levelMask & ~query.levelMask) != 0;
+
+        auto isMatching = [&](std::string_view line) -> bool {
+            // текст: [время] [УРОВЕНЬ] ..., JSON: {"time":"время","level":"УРОВЕНЬ",...
+            const bool   isJson      = line.front() == '{';
+            const size_t timeOffset  = isJson ? LOG_JSON_TIME_OFFSET : 0;
+            const size_t levelOffset = isJson ? LOG_JSON_LEVEL_OFFSET : LOG_TIME_SIZE + 2;
+            if (line.size() < levelOffset) return false;
+
+            if (checkTime) {
+                const std::string_view timeString = line.substr(timeOffset, LOG_TIME_SIZE);
+                if (timeString != lastTimeString) {
+                    lastTimeString = std::string(timeString);
+                    lastTime       = parseLogTime(timeString);
+                }
+                if (lastTime < query.from || lastTime > query.to) return false;
+            }
+
+            if (checkLevel) {
+                const std::string_view level = line.substr(levelOffset);
+                uint32_t               mask  = 0;
+                if (level.rfind("INFO", 0) == 0)
+                    mask = 1u << INFO;
+                else if (level.rfind("WARNING", 0) == 0)
+                    mask = 1u << WARNING;
+                else if (level.rfind("ERROR", 0) == 0)
+                    mask = 1u << ERROR;
+                if ((mask & query.levelMask) == 0) return false;
+            }
+
+            return true;
+        };
+
+        const char* current = begin;
+        while (current < end) {
+            // с подстрокой прыгаем сразу к совпадениям, иначе идём по строкам
+            const char* hit = findSubstring(current, end, query.substring);
+            if (hit == nullptr) break;
+
+            const char* lineBegin = hit;
+            while (lineBegin != current && lineBegin[-1] != '\n') --lineBegin;
+            const char* lineEnd = static_cast<const char*>(std::memchr(hit, '\n', end - hit));
+            if (lineEnd == nullptr) lineEnd = end;
+
+            const std::string_view line(lineBegin, lineEnd - lineBegin);
+            if (!line.empty() && isMatching(line)) {
+                onMatch(line);
+                ++matched;
+            }
+
+            current = lineEnd + 1;
+        }
+
+        munmap(mapped, mappedSize);
+    }
+
+    close(fd);
+    return matched;
+}
+
+std::vector<std::string> LogReader::query(const LogQuery& query) const {
+    std::vector<std::string> lines;
+    this->query(query, [&](std::string_view line) { lines.emplace_back(line); });
+    return lines;
+}
+
+size_t LogReader::getBlockCount() const { return blocks_.size(); }
\ No newline at end of file
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <ctime>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "logger.h"
+#include "logindex.h"
+
+struct LogQuery {
+    std::time_t from      = 0;                     // начало диапазона времени (включительно)
+    std::time_t to        = LOG_INDEX_MAX_TIME;    // конец диапазона времени (включительно)
+    uint32_t    levelMask = LOG_INDEX_ALL_LEVELS;  // бит (1 << LogLevel) для каждого нужного уровня
+    std::string substring;                         // подстрока, которую должна содержать запись
+};
+
+class LogReader {
+   private:
+    std::string                filename_;  // имя файла журнала
+    std::vector<LogIndexEntry> blocks_;    // блоки журнала: из индекса и неиндексированный хвост
+
+    void loadIndex(uint64_t fileSize, uint64_t device, uint64_t inode);  // чтение индекса, если он действителен
+    bool isBlockRelevant(const LogIndexEntry& block, const LogQuery& query) const;  // отсев блока по индексу
+
+   public:
+    explicit LogReader(const std::string& filename);
+
+    size_t query(const LogQuery& query,
+                 const std::function<void(std::string_view)>& onMatch) const;  // обход подходящих записей
+    std::vector<std::string> query(const LogQuery& query) const;                // все подходящие записи
+    size_t                   getBlockCount() const;                             // количество блоков журнала
+};
+
+std::time_t parseLogTime(std::string_view time);  // "dd-mm-YYYY HH:MM:SS" (скобки допускаются) -> время, -1 при ошибке
+const char* findSubstring(const char* begin, const char* end,
+                          std::string_view needle);  // поиск подстроки (SIMD, если доступно)
\ No newline at end of file
@@ -0,0 +1,277 @@
+#include "sharedlog.h"
+
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free && std::atomic<int32_t>::is_always_lock_free,
+              "shared log needs address-free atomics");
+
+namespace {
+
+constexpr uint64_t SHARED_LOG_MASK = SHARED_LOG_RING_CAPACITY - 1;
+
+void validateSharedLogName(const std::string& name) {
+    // имя объекта POSIX: один ведущий слэш и больше ни одного
+    if (name.size() < 2 || name[0] != '/' || name.find('/', 1) != std::string::npos)
+        throw std::invalid_argument("Invalid shared log name: " + name);
+}
+
+bool isProcessAlive(int32_t pid) { return kill(pid, 0) == 0 || errno != ESRCH; }
+
+SharedLogSegment* mapSharedLog(const std::string& name, bool create, LogClockSource clockSource) {
+    validateSharedLogName(name);
+
+    // создает объект только сборщик; O_EXCL решает, кто из одновременно запущенных его размечает
+    bool isCreator = false;
+    int  fd        = -1;
+    if (create) {
+        fd        = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+        isCreator = fd >= 0;
+    }
+    if (fd < 0) fd = shm_open(name.c_str(), O_RDWR, 0);
+    if (fd < 0) throw std::runtime_error("Error: opening shared log " + name + " (is the collector running?)!");
+
+    if (isCreator && ftruncate(fd, sizeof(SharedLogSegment)) != 0) {
+        close(fd);
+        shm_unlink(name.c_str());
+        throw std::runtime_error("Error: resizing shared log!");
+    }
+
+    // чужой создатель мог еще не задать размер
+    struct stat segmentStat {};
+    for (int attempt = 0; fstat(fd, &segmentStat) == 0 && segmentStat.st_size == 0 && attempt != 1000; ++attempt)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    if (static_cast<size_t>(segmentStat.st_size) != sizeof(SharedLogSegment)) {
+        close(fd);
+        throw std::runtime_error("Error: shared log has invalid size!");
+    }
+
+    void* memory = mmap(nullptr, sizeof(SharedLogSegment), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (memory == MAP_FAILED) throw std::runtime_error("Error: mapping shared log!");
+    auto* segment = static_cast<SharedLogSegment*>(memory);
+
+    if (isCreator) {
+        // память объекта уже нулевая: остается пометить ячейки свободными для их первых номеров
+        std::memcpy(segment->magic, SHARED_LOG_MAGIC, sizeof(segment->magic));
+        segment->version     = SHARED_LOG_VERSION;
+        segment->clockSource = clockSource;
+        for (auto& ring : segment->rings) {
+            for (size_t i = 0; i != SHARED_LOG_RING_CAPACITY; ++i)
+                ring.slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+        segment->isReady.store(1, std::memory_order_release);
+    }
+
+    for (int attempt = 0; segment->isReady.load(std::memory_order_acquire) == 0 && attempt != 1000; ++attempt)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    if (segment->isReady.load(std::memory_order_acquire) == 0 ||
+        std::memcmp(segment->magic, SHARED_LOG_MAGIC, sizeof(segment->magic)) != 0 ||
+        segment->version != SHARED_LOG_VERSION) {
+        munmap(segment, sizeof(SharedLogSegment));
+        throw std::runtime_error("Error: shared log has invalid format!");
+    }
+
+    return segment;
+}
+
+}  // namespace
+
+SharedLogProducer::SharedLogProducer(const std::string& name, LogClockSource clockSource)
+    : name_(name), segment_(mapSharedLog(name, false, clockSource)), ring_(nullptr) {
+    // тики сравниваются между процессами, поэтому источник часов у всех один - тот, что выбрал сборщик
+    if (segment_->clockSource != clockSource) {
+        munmap(segment_, sizeof(SharedLogSegment));
+        throw std::runtime_error("Error: shared log uses another clock source!");
+    }
+
+    const int32_t pid = static_cast<int32_t>(getpid());
+    for (auto& ring : segment_->rings) {
+        int32_t expected = 0;
+        if (ring.owner.compare_exchange_strong(expected, pid, std::memory_order_acq_rel)) {
+            ring_ = &ring;
+            break;
+        }
+    }
+    if (ring_ == nullptr) {
+        munmap(segment_, sizeof(SharedLogSegment));
+        throw std::runtime_error("Error: no free ring in shared log!");
+    }
+}
+
+SharedLogProducer::~SharedLogProducer() {
+    // все записи к этому моменту опубликованы: кольцо можно отдать, даже если сборщик его ещё не дочитал
+    ring_->owner.store(0, std::memory_order_release);
+    munmap(segment_, sizeof(SharedLogSegment));
+}
+
+bool SharedLogProducer::push(uint64_t ticks, LogLevel logLevel, std::string_view text) noexcept {
+    const size_t   size  = std::min(text.size(), SHARED_LOG_TEXT_SIZE * SHARED_LOG_MAX_SLOTS);
+    const uint64_t count = std::max<uint64_t>(1, (size + SHARED_LOG_TEXT_SIZE - 1) / SHARED_LOG_TEXT_SIZE);
+
+    // номера занимаются подряд одним CAS: сборщик освобождает ячейки по порядку,
+    // поэтому если свободна последняя из нужных, то свободны и все перед ней
+    uint64_t ticket = ring_->tail.load(std::memory_order_relaxed);
+    while (true) {
+        const uint64_t last     = ticket + count - 1;
+        const uint64_t sequence = ring_->slots[last & SHARED_LOG_MASK].sequence.load(std::memory_order_acquire);
+        if (sequence == last) {
+            if (ring_->tail.compare_exchange_weak(ticket, ticket + count, std::memory_order_acq_rel,
+                                                  std::memory_order_relaxed))
+                break;
+        } else if (sequence < last) {
+            ring_->overflowed.fetch_add(1, std::memory_order_relaxed);
+            return false;  // сборщик отстал на целое кольцо
+        } else {
+            ticket = ring_->tail.load(std::memory_order_relaxed);  // номер уже занял другой поток
+        }
+    }
+
+    // продолжения публикуются раньше первой ячейки: увидев её, сборщик видит и всю запись
+    for (uint64_t i = count; i-- != 0;) {
+        SharedLogSlot& slot   = ring_->slots[(ticket + i) & SHARED_LOG_MASK];
+        const size_t   offset = i * SHARED_LOG_TEXT_SIZE;
+        slot.slotCount        = i == 0 ? static_cast<uint16_t>(count) : 0;
+        if (i == 0) {
+            slot.ticks    = ticks;
+            slot.size     = static_cast<uint32_t>(size);
+            slot.logLevel = static_cast<uint8_t>(logLevel);
+        }
+        std::memcpy(slot.text, text.data() + offset, std::min(size - offset, SHARED_LOG_TEXT_SIZE));
+        slot.sequence.store(ticket + i + 1, std::memory_order_release);
+    }
+
+    return true;
+}
+
+const std::string& SharedLogProducer::getName() const { return name_; }
+
+SharedLogCollector::SharedLogCollector(const std::string& name, Logger& logger)
+    : name_(name), segment_(mapSharedLog(name, true, logger.getClock().getSource())), logger_(logger) {
+    // сборщик один: после падения прежнего новый продолжает с того же места
+    const int32_t pid      = static_cast<int32_t>(getpid());
+    int32_t       previous = segment_->collector.load(std::memory_order_acquire);
+    bool          isOwner  = false;
+    while (!isOwner && (previous == 0 || !isProcessAlive(previous))) {
+        isOwner = segment_->collector.compare_exchange_weak(previous, pid, std::memory_order_acq_rel);
+    }
+    if (!isOwner) {  // живой сборщик, в том числе в этом же процессе
+        munmap(segment_, sizeof(SharedLogSegment));
+        throw std::runtime_error("Error: shared log already has a collector!");
+    }
+    if (segment_->clockSource != logger.getClock().getSource()) {
+        segment_->collector.store(0, std::memory_order_release);
+        munmap(segment_, sizeof(SharedLogSegment));
+        throw std::runtime_error("Error: shared log uses another clock source!");
+    }
+}
+
+SharedLogCollector::~SharedLogCollector() {
+    segment_->collector.store(0, std::memory_order_release);
+    munmap(segment_, sizeof(SharedLogSegment));
+}
+
+void SharedLogCollector::drainRing(SharedLogRing& ring) {
+    uint64_t head = ring.head.load(std::memory_order_relaxed);
+    while (true) {
+        SharedLogSlot& slot = ring.slots[head & SHARED_LOG_MASK];
+        if (slot.sequence.load(std::memory_order_acquire) == head + 1) {
+            const uint64_t count = slot.slotCount;
+            if (count == 0) {  // продолжение записи, начало которой освобождено после падения владельца
+                slot.sequence.store(head + SHARED_LOG_RING_CAPACITY, std::memory_order_release);
+                ring.reclaimed.fetch_add(1, std::memory_order_relaxed);
+                ++head;
+                continue;
+            }
+
+            SharedLogPending pending{slot.ticks, static_cast<LogLevel>(slot.logLevel), std::string()};
+            pending.text.reserve(slot.size);
+            for (uint64_t i = 0; i != count; ++i) {
+                SharedLogSlot& chunk = ring.slots[(head + i) & SHARED_LOG_MASK];
+                const size_t   left  = slot.size - pending.text.size();
+                pending.text.append(chunk.text, std::min(left, SHARED_LOG_TEXT_SIZE));
+                chunk.sequence.store(head + i + SHARED_LOG_RING_CAPACITY, std::memory_order_release);
+            }
+            pending_.push_back(std::move(pending));
+            head += count;
+            continue;
+        }
+
+        // ячейка занята, но не заполнена: ждём, пока владелец жив, иначе освобождаем её
+        if (ring.tail.load(std::memory_order_acquire) == head) break;
+        const int32_t owner = ring.owner.load(std::memory_order_acquire);
+        if (owner == 0 || isProcessAlive(owner)) break;
+
+        slot.sequence.store(head + SHARED_LOG_RING_CAPACITY, std::memory_order_release);
+        ring.reclaimed.fetch_add(1, std::memory_order_relaxed);
+        ++head;
+    }
+    ring.head.store(head, std::memory_order_release);
+
+    // кольцо упавшего процесса, вычитанное до конца, снова свободно
+    int32_t owner = ring.owner.load(std::memory_order_acquire);
+    if (owner != 0 && ring.tail.load(std::memory_order_acquire) == head && !isProcessAlive(owner))
+        ring.owner.compare_exchange_strong(owner, 0, std::memory_order_acq_rel);
+}
+
+size_t SharedLogCollector::drain(bool isFinal) {
+    const size_t before = pending_.size();
+    for (auto& ring : segment_->rings) drainRing(ring);
+
+    // в каждом кольце записи уже по порядку, а недописанное прошлым проходом - в начале pending_
+    std::stable_sort(pending_.begin() + static_cast<std::ptrdiff_t>(before), pending_.end(),
+                     [](const SharedLogPending& a, const SharedLogPending& b) { return a.ticks < b.ticks; });
+    std::inplace_merge(pending_.begin(), pending_.begin() + static_cast<std::ptrdiff_t>(before), pending_.end(),
+                       [](const SharedLogPending& a, const SharedLogPending& b) { return a.ticks < b.ticks; });
+
+    // свежие записи ждут окна: производитель, взявший тики раньше, мог ещё не успеть их опубликовать
+    const LogClock& clock = logger_.getClock();
+    const uint64_t  now   = clock.now();
+    size_t          count = 0;
+    while (count != pending_.size() &&
+           (isFinal || (pending_[count].ticks <= now &&
+                        clock.toNanoseconds(now - pending_[count].ticks) >= SHARED_LOG_REORDER_WINDOW)))
+        ++count;
+    if (count == 0) return 0;
+
+    records_.clear();
+    for (size_t i = 0; i != count; ++i)
+        records_.push_back({pending_[i].text, LogEvent(), pending_[i].logLevel, pending_[i].ticks});
+    logger_.logBatch(records_.data(), records_.size());
+    pending_.erase(pending_.begin(), pending_.begin() + static_cast<std::ptrdiff_t>(count));
+
+    return count;
+}
+
+uint64_t SharedLogCollector::getOverflowed() const {
+    uint64_t total = 0;
+    for (const auto& ring : segment_->rings) total += ring.overflowed.load(std::memory_order_relaxed);
+    return total;
+}
+
+uint64_t SharedLogCollector::getReclaimed() const {
+    uint64_t total = 0;
+    for (const auto& ring : segment_->rings) total += ring.reclaimed.load(std::memory_order_relaxed);
+    return total;
+}
+
+size_t SharedLogCollector::getProducerCount() const {
+    size_t count = 0;
+    for (const auto& ring : segment_->rings) count += ring.owner.load(std::memory_order_acquire) != 0;
+    return count;
+}
+
+void SharedLogCollector::remove(const std::string& name) {
+    validateSharedLogName(name);
+    if (shm_unlink(name.c_str()) != 0 && errno != ENOENT) throw std::runtime_error("Error: removing shared log!");
+}
\ No newline at end of file
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "logger.h"
+
+// общий журнал нескольких процессов: у каждого процесса свое кольцо в разделяемой памяти POSIX (shm_open),
+// потоки процесса занимают в нем ячейки без блокировок, а один процесс-сборщик вычитывает все кольца,
+// упорядочивает записи по тикам и пишет их в файл. ячейки, брошенные упавшим процессом, сборщик освобождает сам
+
+constexpr char     SHARED_LOG_MAGIC[8]        = "LOGSHM1";
+constexpr uint32_t SHARED_LOG_VERSION         = 1;
+constexpr size_t   SHARED_LOG_RING_COUNT      = 16;        // процессов-производителей одновременно
+constexpr size_t   SHARED_LOG_RING_CAPACITY   = 1024;      // ячеек в кольце (степень двойки)
+constexpr size_t   SHARED_LOG_TEXT_SIZE       = 232;       // текста в одной ячейке
+constexpr size_t   SHARED_LOG_MAX_SLOTS       = 64;        // длиннее сообщения обрезаются
+constexpr int64_t  SHARED_LOG_REORDER_WINDOW  = 20000000;  // наносекунд: столько сборщик ждет отставшие записи
+
+struct SharedLogSlot {  // ячейка кольца, запись длиннее SHARED_LOG_TEXT_SIZE занимает несколько подряд
+    std::atomic<uint64_t> sequence;   // == номер - ячейка свободна для него, номер + 1 - заполнена
+    uint64_t              ticks;      // LogClock::now() производителя (первая ячейка записи)
+    uint32_t              size;       // длина всего текста (первая ячейка)
+    uint16_t              slotCount;  // ячеек в записи, 0 - продолжение предыдущей
+    uint8_t               logLevel;   // уровень важности (первая ячейка)
+    char                  text[SHARED_LOG_TEXT_SIZE];
+};
+
+struct SharedLogRing {  // кольцо одного процесса: пишут его потоки, читает только сборщик
+    alignas(64) std::atomic<int32_t> owner;  // pid владельца, 0 - кольцо свободно
+    std::atomic<uint64_t> overflowed;        // записей, не принятых push: Logger пишет их в свой файл
+    alignas(64) std::atomic<uint64_t> tail;  // следующий номер для производителей
+    alignas(64) std::atomic<uint64_t> head;  // следующий номер для сборщика
+    std::atomic<uint64_t> reclaimed;         // ячеек, брошенных упавшим владельцем
+    SharedLogSlot         slots[SHARED_LOG_RING_CAPACITY];
+};
+
+struct SharedLogSegment {  // весь объект разделяемой памяти
+    char                  magic[8];     // SHARED_LOG_MAGIC
+    uint32_t              version;      // SHARED_LOG_VERSION
+    int32_t               clockSource;  // часы сборщика: тики всех процессов должны быть одного источника
+    std::atomic<uint32_t> isReady;      // создатель закончил разметку
+    std::atomic<int32_t>  collector;    // pid сборщика, 0 - нет
+    SharedLogRing         rings[SHARED_LOG_RING_COUNT];
+};
+
+class SharedLogProducer {  // кольцо текущего процесса, занимается при создании и освобождается при разрушении
+   private:
+    std::string       name_;     // имя объекта разделяемой памяти ("/game")
+    SharedLogSegment* segment_;  // отображенный объект
+    SharedLogRing*    ring_;     // свое кольцо
+
+   public:
+    SharedLogProducer(const std::string& name, LogClockSource clockSource);  // объект создает сборщик
+    ~SharedLogProducer();
+
+    bool push(uint64_t ticks, LogLevel logLevel, std::string_view text) noexcept;  // false - кольцо заполнено
+    const std::string& getName() const;
+};
+
+struct SharedLogPending {  // запись, вычитанная из кольца, но ещё не записанная в файл
+    uint64_t    ticks;     // тики производителя
+    LogLevel    logLevel;  // уровень важности
+    std::string text;      // текст сообщения
+};
+
+class SharedLogCollector {  // единственный читатель всех колец, пишет в свой журнал
+   private:
+    std::string                   name_;     // имя объекта разделяемой памяти
+    SharedLogSegment*             segment_;  // отображенный объект
+    Logger&                       logger_;   // куда пишутся записи
+    std::vector<SharedLogPending> pending_;  // отсортированы по тикам, ждут окна переупорядочивания
+    std::vector<LogRecord>        records_;  // пачка для logBatch
+
+    void drainRing(SharedLogRing& ring);  // все готовые записи кольца в pending_
+
+   public:
+    SharedLogCollector(const std::string& name, Logger& logger);  // создает объект или подключается к нему
+    ~SharedLogCollector();
+
+    size_t   drain(bool isFinal = false);  // записать готовое, isFinal - не ждать отставших; возвращает число строк
+    uint64_t getOverflowed() const;        // не поместилось в кольца (по всем процессам)
+    uint64_t getReclaimed() const;         // освобождено ячеек упавших процессов
+    size_t   getProducerCount() const;     // сколько колец занято
+
+    static void remove(const std::string& name);  // удалить объект разделяемой памяти
+};
\ No newline at end of file
@@ -0,0 +1,140 @@
+#include "tracer.h"
+
+#include <unistd.h>
+
+#include <fstream>
+#include <stdexcept>
+
+#include "logevent.h"
+
+namespace {
+
+std::atomic<uint64_t> traceGenerations(0);  // номера трассировщиков не повторяются, в отличие от адресов
+
+struct TraceCache {  // буфер текущего потока у последнего трассировщика, которым он пользовался
+    uint64_t     generation;
+    TraceBuffer* buffer;
+};
+
+thread_local TraceCache traceCache = {0, nullptr};
+
+}  // namespace
+
+Tracer::Tracer(const LogClock& clock, size_t capacity)
+    : clock_(clock), generation_(traceGenerations.fetch_add(1) + 1), capacity_(1), isEnabled_(true) {
+    while (capacity_ < capacity) capacity_ <<= 1;  // для деления по маске
+}
+
+TraceBuffer& Tracer::getBuffer() {
+    if (traceCache.generation == generation_) return *traceCache.buffer;
+
+    // медленный путь - первый отрезок потока или смена трассировщика
+    const int                   threadId = static_cast<int>(gettid());
+    std::lock_guard<std::mutex> lock(buffersMutex_);
+
+    TraceBuffer* found = nullptr;
+    for (const auto& buffer : buffers_) {
+        if (buffer->threadId == threadId) found = buffer.get();
+    }
+    if (found == nullptr) {
+        auto buffer      = std::make_unique<TraceBuffer>();
+        buffer->threadId = threadId;
+        buffer->capacity = capacity_;
+        buffer->events   = std::make_unique<TraceEvent[]>(capacity_);
+        buffer->head.store(0, std::memory_order_relaxed);
+        found = buffer.get();
+        buffers_.push_back(std::move(buffer));
+    }
+
+    traceCache = {generation_, found};
+    return *found;
+}
+
+void Tracer::setEnabled(bool isEnabled) { isEnabled_.store(isEnabled, std::memory_order_relaxed); }
+
+void Tracer::record(const char* name, uint64_t begin, uint64_t end, const char* argName, int64_t argValue) noexcept {
+    // писатель у буфера один, поэтому номер - обычное чтение и запись; seqlock - для экспорта
+    TraceBuffer&   buffer = getBuffer();
+    const uint64_t ticket = buffer.head.load(std::memory_order_relaxed);
+    TraceEvent&    event  = buffer.events[ticket & (buffer.capacity - 1)];
+
+    event.sequence.store(ticket * 2 + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    event.name     = name;
+    event.argName  = argName;
+    event.argValue = argValue;
+    event.begin    = begin;
+    event.end      = end;
+    event.sequence.store(ticket * 2 + 2, std::memory_order_release);
+
+    buffer.head.store(ticket + 1, std::memory_order_release);
+}
+
+namespace {
+
+void appendMicroseconds(std::string& out, int64_t nanoseconds) {  // микросекунды с тремя знаками, без double
+    if (nanoseconds < 0) nanoseconds = 0;
+    const std::string fraction = std::to_string(nanoseconds % 1000);
+    out += std::to_string(nanoseconds / 1000);
+    out += '.';
+    out.append(3 - fraction.size(), '0');
+    out += fraction;
+}
+
+}  // namespace
+
+size_t Tracer::exportChromeTrace(std::ostream& out) const {
+    // время - настенное, в микросекундах: трассы разных процессов и журнал можно сопоставить
+    const std::string pid = std::to_string(getpid());
+    std::string       json;
+    size_t            count = 0;
+    json += "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+
+    std::lock_guard<std::mutex> lock(buffersMutex_);
+    for (const auto& buffer : buffers_) {
+        const uint64_t head  = buffer->head.load(std::memory_order_acquire);
+        const uint64_t first = head > buffer->capacity ? head - buffer->capacity : 0;
+
+        for (uint64_t ticket = first; ticket != head; ++ticket) {
+            const TraceEvent& slot     = buffer->events[ticket & (buffer->capacity - 1)];
+            const uint64_t    expected = ticket * 2 + 2;
+            if (slot.sequence.load(std::memory_order_acquire) != expected) continue;
+
+            const char*    name     = slot.name;
+            const char*    argName  = slot.argName;
+            const int64_t  argValue = slot.argValue;
+            const uint64_t begin = slot.begin, end = slot.end;
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.sequence.load(std::memory_order_relaxed) != expected) continue;  // поток уже перезаписал
+
+            json += count++ == 0 ? "{" : ",{";
+            json += "\"name\":";
+            appendJsonString(json, name);
+            json += ",\"ph\":\"X\",\"ts\":";
+            appendMicroseconds(json, clock_.toWallTime(begin));
+            json += ",\"dur\":";
+            appendMicroseconds(json, clock_.toNanoseconds(end - begin));
+            json += ",\"pid\":" + pid + ",\"tid\":" + std::to_string(buffer->threadId);
+            if (argName != nullptr) {
+                json += ",\"args\":{";
+                appendJsonString(json, argName);
+                json += ':' + std::to_string(argValue) + '}';
+            }
+            json += '}';
+        }
+    }
+
+    json += "]}\n";
+    out << json;
+    return count;
+}
+
+size_t Tracer::writeChromeTrace(const std::string& filename) const {
+    std::ofstream file(filename, std::ios::trunc);
+    if (!file.is_open()) throw std::runtime_error("Error: opening trace file!");
+
+    const size_t count = exportChromeTrace(file);
+    file.flush();
+    if (!file.good()) throw std::runtime_error("Error: writing trace file!");
+    return count;
+}
\ No newline at end of file
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "logclock.h"
+
+// трассировка: отрезки времени (TraceSpan) пишутся в буфер своего потока без блокировок и без перевода
+// времени - только два чтения тиков и запись ячейки. в JSON Chrome/Perfetto (chrome://tracing, ui.perfetto.dev)
+// буферы превращаются только по запросу, старые события в буфере перезаписываются новыми
+
+constexpr size_t TRACE_BUFFER_CAPACITY = 16384;  // событий на поток по умолчанию
+
+struct TraceEvent {  // завершенный отрезок, в JSON - событие "ph":"X"
+    std::atomic<uint64_t> sequence;  // seqlock: нечётное значение - запись ещё идёт
+    const char*           name;      // имя отрезка (строковый литерал)
+    const char*           argName;   // имя аргумента (строковый литерал), nullptr - без аргумента
+    int64_t               argValue;  // значение аргумента
+    uint64_t              begin;     // тики LogClock
+    uint64_t              end;       // тики LogClock
+};
+
+struct TraceBuffer {  // кольцевой буфер одного потока: пишет только он, читает экспорт
+    int                           threadId;  // gettid потока
+    size_t                        capacity;  // степень двойки
+    std::unique_ptr<TraceEvent[]> events;    // события
+    std::atomic<uint64_t>         head;      // номер следующего события
+};
+
+class Tracer {  // отрезки всех потоков и их выгрузка в формате Chrome trace event
+   private:
+    const LogClock&                           clock_;         // часы журнала: тики и их перевод в настенное время
+    uint64_t                                  generation_;    // номер трассировщика для кэша потоков
+    size_t                                    capacity_;      // размер буфера потока
+    std::atomic<bool>                         isEnabled_;     // выключенный трассировщик отрезки не пишет
+    mutable std::mutex                        buffersMutex_;  // для списка буферов
+    std::vector<std::unique_ptr<TraceBuffer>> buffers_;       // буферы потоков, живут до конца трассировщика
+
+    TraceBuffer& getBuffer();  // буфер текущего потока, после первого раза - из thread_local кэша
+
+   public:
+    explicit Tracer(const LogClock& clock, size_t capacity = TRACE_BUFFER_CAPACITY);
+
+    uint64_t now() const { return clock_.now(); }
+    bool     isEnabled() const { return isEnabled_.load(std::memory_order_relaxed); }
+    void     setEnabled(bool isEnabled);  // включить или приостановить запись отрезков
+    void     record(const char* name, uint64_t begin, uint64_t end, const char* argName,
+                    int64_t argValue) noexcept;                    // завершенный отрезок в буфер потока
+    size_t   exportChromeTrace(std::ostream& out) const;           // JSON в поток, возвращает число событий
+    size_t   writeChromeTrace(const std::string& filename) const;  // JSON в файл, при ошибке - исключение
+};
+
+class TraceSpan {  // отрезок от создания до разрушения объекта
+   private:
+    Tracer*     tracer_;    // nullptr - трассировка выключена, отрезок ничего не делает
+    const char* name_;      // имя отрезка
+    const char* argName_;   // имя аргумента или nullptr
+    int64_t     argValue_;  // значение аргумента
+    uint64_t    begin_;     // тики начала
+
+   public:
+    TraceSpan(Tracer* tracer, const char* name, const char* argName = nullptr, int64_t argValue = 0)
+        : tracer_(tracer != nullptr && tracer->isEnabled() ? tracer : nullptr),
+          name_(name),
+          argName_(argName),
+          argValue_(argValue),
+          begin_(tracer_ != nullptr ? tracer_->now() : 0) {}
+    ~TraceSpan() {
+        if (tracer_ != nullptr) tracer_->record(name_, begin_, tracer_->now(), argName_, argValue_);
+    }
+
+    TraceSpan(const TraceSpan&)            = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+};
\ No newline at end of file
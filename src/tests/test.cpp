@@ -1,10 +1,31 @@
+#include <logger/affinity.h>
+#include <logger/configwatcher.h>
+#include <logger/flightrecorder.h>
+#include <logger/logbackend.h>
 #include <logger/logger.h>
-
+#include <logger/reader.h>
+#include <logger/sharedlog.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <cmath>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
 #include <fstream>
 #include <functional>
+#include <iomanip>
 #include <iostream>
 #include <memory>
+#include <queue>
 #include <random>
 #include <sstream>
 #include <string>
@@ -12,12 +33,32 @@
 #include <utility>
 #include <vector>
 
+#include "../app/bot.h"
+#include "../app/dynamicmaze.h"
+#include "../app/input.h"
 #include "../app/manager.h"
+#include "../app/mazepack.h"
+#include "../app/recordpool.h"
+#include "../app/server.h"
+#include "../app/session.h"
+#include "../app/simulation.h"
 
 typedef std::vector<std::pair<std::string, std::function<void()>>> TEST_TYPE;
 
 std::unique_ptr<MultithreadAppManager> app = nullptr;
 
+std::atomic<size_t> allocationCount(0);  // все выделения памяти в тестах, для проверок "без malloc"
+
+void* operator new(size_t size) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (void* pointer = std::malloc(size == 0 ? 1 : size)) return pointer;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* pointer) noexcept { std::free(pointer); }
+
+void operator delete(void* pointer, size_t) noexcept { std::free(pointer); }
+
 void runTests(const TEST_TYPE& tests) {
     for (const auto& pair : tests) {
         try {
@@ -252,6 +293,663 @@ int main() {
                                   assert(file.is_open());
                               }},
 
+                             {"testIndexedQuery",
+                              []() {
+                                  const std::string filename = "test_log.txt";
+                                  std::remove(filename.c_str());
+                                  std::remove(getLogIndexFilename(filename).c_str());
+
+                                  {
+                                      Logger logger(filename, INFO, FAST);
+                                      for (int i = 0; i < 20000; ++i) {
+                                          logger.log("Indexed message " + std::to_string(i));
+                                          if (i % 1000 == 0) logger.log("Rare error " + std::to_string(i), ERROR);
+                                      }
+                                  }
+
+                                  LogReader reader(filename);
+                                  assert(reader.getBlockCount() > 1);
+
+                                  LogQuery errors;
+                                  errors.levelMask = 1u << ERROR;
+                                  assert(reader.query(errors).size() == 20);
+
+                                  LogQuery substring;
+                                  substring.substring = "Indexed message 1999";
+                                  const auto lines    = reader.query(substring);
+                                  assert(lines.size() == 11);  // 1999 и 19990..19999
+                                  assert(lines.front().find("[INFO] Indexed message 1999") != std::string::npos);
+
+                                  LogQuery past;
+                                  past.to = 0;
+                                  assert(reader.query(past).empty());
+                              }},
+
+                             {"testIndexAppendAfterReopen",
+                              []() {
+                                  const std::string filename = "test_log.txt";
+                                  std::remove(filename.c_str());
+                                  std::remove(getLogIndexFilename(filename).c_str());
+
+                                  { Logger(filename).log("First run"); }
+                                  { Logger(filename).log("Second run", WARNING); }
+
+                                  LogReader reader(filename);
+                                  LogQuery  query;
+                                  query.substring = "run";
+                                  assert(reader.query(query).size() == 2);
+
+                                  query.levelMask = 1u << WARNING;
+                                  const auto lines = reader.query(query);
+                                  assert(lines.size() == 1 && lines.front().find("Second run") != std::string::npos);
+                              }},
+
+                             {"testComponentLogLevels",
+                              []() {
+                                  const std::string filename = "test_log.txt";
+                                  std::remove(filename.c_str());
+                                  Logger logger(filename, WARNING);
+
+                                  LogComponent& player     = logger.getComponent("Player");
+                                  LogComponent& playerMove = logger.getComponent("Player.Move");
+                                  LogComponent& gameField  = logger.getComponent("GameField");
+                                  gameField.changeLogLevel(INFO);
+
+                                  player.log("Player info");
+                                  playerMove.log("Player move info");
+                                  gameField.log("GameField info");
+                                  assert(!player.isEnabled(INFO) && playerMove.isEnabled(WARNING));
+
+                                  player.changeLogLevel(INFO);  // потомок без своего уровня наследует
+                                  playerMove.log("Player move after change");
+
+                                  logger.changeLogLevel(ERROR);
+                                  gameField.log("GameField still info");
+                                  player.resetLogLevel();
+                                  playerMove.log("Player move filtered again", WARNING);
+
+                                  std::ifstream logFile(filename);
+                                  std::string   line, content;
+                                  while (std::getline(logFile, line)) content += line + '\n';
+
+                                  assert(content.find("Player info") == std::string::npos);
+                                  assert(content.find("Player move info") == std::string::npos);
+                                  assert(content.find("GameField info") != std::string::npos);
+                                  assert(content.find("Player move after change") != std::string::npos);
+                                  assert(content.find("GameField still info") != std::string::npos);
+                                  assert(content.find("Player move filtered again") == std::string::npos);
+                              }},
+
+                             {"testStructuredEvents",
+                              []() {
+                                  const std::string filename = "test_log.txt";
+                                  std::remove(filename.c_str());
+                                  Logger logger(filename, WARNING);
+
+                                  logger.logEvent(LogEvent("Player::processMove", "moving up. New coordinates: {}",
+                                                           {pointField("position", 3, 7), intField("moves", 12)}),
+                                                  WARNING);
+                                  logger.logEvent(LogEvent("Player::processMove", "filtered {}", {intField("x", 1)}));
+
+                                  logger.changeLogFormat(JSON);
+                                  logger.logEvent(LogEvent("Player::play", "finished \"maze\" in {} seconds.",
+                                                           {durationField("time", std::chrono::milliseconds(1500))}),
+                                                  ERROR);
+                                  logger.log("plain message", ERROR);
+
+                                  std::ifstream logFile(filename);
+                                  std::string   text, json, plain;
+                                  std::getline(logFile, text);
+                                  std::getline(logFile, json);
+                                  std::getline(logFile, plain);
+
+                                  assert(text.find("[WARNING] Player::processMove | moving up. New coordinates: 3;7 "
+                                                   "moves=12") != std::string::npos);
+                                  assert(json.front() == '{' && json.find("\"level\":\"ERROR\"") != std::string::npos);
+                                  assert(json.find("\"event\":\"Player::play\"") != std::string::npos);
+                                  assert(json.find("\"message\":\"finished \\\"maze\\\" in {} seconds.\"") !=
+                                         std::string::npos);
+                                  assert(json.find("\"fields\":{\"time\":1500000000}") != std::string::npos);
+                                  assert(plain.find("\"message\":\"plain message\"}") != std::string::npos);
+
+                                  LogReader reader(filename);
+                                  LogQuery  errors;
+                                  errors.levelMask = 1u << ERROR;
+                                  errors.from      = 1;
+                                  assert(reader.query(errors).size() == 2);
+                              }},
+
+                             {"testFlightRecorderDumpOnCrash",
+                              []() {
+                                  const std::string filename = "test_log.txt", dumpFilename = "test_crash_dump.log";
+                                  std::remove(filename.c_str());
+                                  std::remove(dumpFilename.c_str());
+
+                                  const pid_t child = fork();
+                                  if (child == 0) {
+                                      Logger logger(filename, ERROR, FAST);
+                                      logger.enableFlightRecorder(dumpFilename, 8);
+                                      for (int i = 0; i < 20; ++i) logger.log("Filtered " + std::to_string(i));
+                                      logger.getComponent("Player").logEvent(
+                                          LogEvent("Player::processMove", "moving up. New coordinates: {}",
+                                                   {pointField("position", 3, 7)}));
+                                      {
+                                          // строка поля умирает задолго до сброса
+                                          std::string name = "temporary client";
+                                          const LogEvent event("Server", "client {}",
+                                                               {stringField("name", name.c_str())});
+                                          logger.logEvent(event, INFO);
+                                          name.assign(name.size(), 'x');
+                                      }
+                                      logger.log("Last words", ERROR);
+                                      std::abort();
+                                  }
+
+                                  int status = 0;
+                                  waitpid(child, &status, 0);
+                                  assert(WIFSIGNALED(status) && WTERMSIG(status) == SIGABRT);
+
+                                  std::ifstream dumpFile(dumpFilename);
+                                  std::string   line, content;
+                                  while (std::getline(dumpFile, line)) content += line + '\n';
+
+                                  assert(content.find("last 8 records") != std::string::npos);
+                                  assert(content.find("[INFO] Filtered 19") != std::string::npos);
+                                  assert(content.find("Filtered 11") == std::string::npos);
+                                  assert(content.find("[INFO] Player::processMove | moving up. New coordinates: 3;7") !=
+                                         std::string::npos);
+                                  assert(content.find("[INFO] Server | client temporary client") != std::string::npos);
+                                  assert(content.find("[ERROR] Last words") != std::string::npos);
+                                  std::remove(dumpFilename.c_str());
+                              }},
+
+                             {"testFlightRecorderConcurrentWriters",
+                              []() {
+                                  // буфер на две записи и четыре писателя: ячейки всё время переходят из рук в руки,
+                                  // но в любом сбросе у записи текст только одного писателя
+                                  const std::string dumpFilename = "test_crash_dump.log";
+                                  FlightRecorder    recorder(dumpFilename, 2);
+                                  auto              checkDump = [&recorder, &dumpFilename]() {
+                                      const int fd = open(dumpFilename.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+                                      assert(fd >= 0);
+                                      recorder.dump(fd);
+                                      close(fd);
+
+                                      std::ifstream dumpFile(dumpFilename);
+                                      std::string   line;
+                                      while (std::getline(dumpFile, line)) {
+                                          if (line.rfind("---", 0) == 0) continue;
+                                          const std::string text = line.substr(line.find("[INFO] ") + 7);
+                                          assert(text.size() == FLIGHT_RECORD_TEXT_SIZE);
+                                          assert(text.find_first_not_of(text[0]) == std::string::npos);
+                                      }
+                                  };
+
+                                  std::atomic<bool>        isDone(false);
+                                  std::vector<std::thread> threads;
+                                  for (char symbol = 'a'; symbol != 'e'; ++symbol) {
+                                      threads.emplace_back([&recorder, symbol]() {
+                                          const std::string message(FLIGHT_RECORD_TEXT_SIZE, symbol);
+                                          for (int i = 0; i < 200000; ++i) recorder.record(message, INFO);
+                                      });
+                                  }
+                                  std::thread checker([&isDone, &checkDump]() {
+                                      while (!isDone.load()) checkDump();
+                                  });
+                                  for (auto& thread : threads) thread.join();
+                                  isDone = true;
+                                  checker.join();
+                                  checkDump();
+                                  std::remove(dumpFilename.c_str());
+                              }},
+
+                             {"testConfigHotReload",
+                              []() {
+                                  const std::string filename = "test_log.txt", configFilename = "test_logger.conf";
+                                  std::remove(filename.c_str());
+                                  std::ofstream(configFilename) << "level=ERROR\n";
+
+                                  Logger           logger(filename, INFO);
+                                  LogConfigWatcher watcher(logger, configFilename);
+                                  assert(watcher.getReloadCount() == 1 && logger.getLogLevel() == ERROR);
+
+                                  auto waitReload = [&watcher](size_t count) {
+                                      for (int i = 0; i < 200 && watcher.getReloadCount() < count; ++i)
+                                          std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                                      return watcher.getReloadCount() >= count;
+                                  };
+
+                                  std::ofstream(configFilename) << "# comment\nlevel = WARNING\nformat=JSON\n"
+                                                                   "component.Player=ERROR\n";
+                                  assert(waitReload(2));
+                                  assert(logger.getLogLevel() == WARNING && logger.getLogFormat() == JSON);
+                                  assert(logger.getComponent("Player").getLogLevel() == ERROR);
+
+                                  // ошибка в файле - старые настройки остаются
+                                  std::ofstream(configFilename) << "level=LOUD\n";
+                                  assert(!watcher.reload() && logger.getLogLevel() == WARNING);
+
+                                  std::ofstream(configFilename) << "level=INFO\ncomponent.Player=INHERIT\n";
+                                  LogConfigWatcher::installSighupHandler();
+                                  const size_t count = watcher.getReloadCount();
+                                  kill(getpid(), SIGHUP);
+                                  assert(waitReload(count + 1));
+                                  assert(logger.getLogLevel() == INFO);
+                                  assert(logger.getComponent("Player").getLogLevel() == INFO);
+
+                                  // тот же файл под другим путем не переоткрывается: после переименования
+                                  // журнал остается прежним, а уровень и формат меняются одним снимком
+                                  std::rename(filename.c_str(), "test_log_rotated.txt");
+                                  std::ofstream(configFilename)
+                                      << "file=./" << filename << "\nlevel=ERROR\nformat=TEXT\n";
+                                  assert(watcher.reload() && !std::filesystem::exists(filename));
+                                  const LogSettings settings = logger.getSettings();
+                                  assert(settings.logLevel == ERROR && settings.logFormat == TEXT);
+                                  assert(logger.getComponent("Player").getLogLevel() == ERROR);
+                                  std::remove("test_log_rotated.txt");
+                                  std::remove(configFilename.c_str());
+                              }},
+
+                             {"testLogBatch",
+                              []() {
+                                  const std::string filename = "test_log.txt";
+                                  std::remove(filename.c_str());
+                                  std::remove(getLogIndexFilename(filename).c_str());
+
+                                  // пачка пишется без фильтрации: уровни проверил тот, кто ее собрал.
+                                  // записи ссылаются на текст, поэтому строки живут отдельно
+                                  std::vector<std::string> texts(5000);
+                                  std::vector<LogRecord>   records;
+                                  for (int i = 0; i != 5000; ++i) {
+                                      texts[i] = "Batch message " + std::to_string(i);
+                                      if (i % 2 == 0)
+                                          records.push_back({texts[i], LogEvent(), i % 100 == 0 ? ERROR : INFO});
+                                      else
+                                          records.push_back({std::string_view(),
+                                                             LogEvent("Batch::event", "number {}",
+                                                                      {intField("number", i)}),
+                                                             WARNING});
+                                  }
+                                  records.push_back({std::string_view(), LogEvent(), INFO});  // пустое не пишется
+
+                                  {
+                                      Logger logger(filename, ERROR);
+                                      logger.logBatch(records.data(), records.size());
+                                      logger.logBatch(records.data(), 0);
+                                  }
+
+                                  std::ifstream            logFile(filename);
+                                  std::string              line;
+                                  std::vector<std::string> lines;
+                                  while (std::getline(logFile, line)) lines.push_back(line);
+                                  assert(lines.size() == 5000);
+                                  assert(lines[0].find("] [ERROR] Batch message 0") != std::string::npos);
+                                  assert(lines[1].find("] [WARNING] Batch::event | number 1") != std::string::npos);
+                                  assert(lines[4998].find("] [INFO] Batch message 4998") != std::string::npos);
+
+                                  // индекс учитывает каждую строку пачки
+                                  LogReader reader(filename);
+                                  assert(reader.getBlockCount() > 1);
+                                  LogQuery errors;
+                                  errors.levelMask = 1u << ERROR;
+                                  assert(reader.query(errors).size() == 50);
+                                  LogQuery warnings;
+                                  warnings.levelMask = 1u << WARNING;
+                                  assert(reader.query(warnings).size() == 2500);
+
+                                  std::remove(filename.c_str());
+                                  {
+                                      Logger logger(filename, INFO, FAST, JSON);
+                                      logger.logBatch(records.data(), 2);
+                                  }
+                                  std::ifstream jsonFile(filename);
+                                  std::getline(jsonFile, line);
+                                  assert(line.find("\"message\":\"Batch message 0\"") != std::string::npos);
+                                  std::getline(jsonFile, line);
+                                  assert(line.find("\"event\":\"Batch::event\"") != std::string::npos);
+                              }},
+
+                             {"testLogClock",
+                              []() {
+                                  const int64_t systemNow = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                                                std::chrono::system_clock::now().time_since_epoch())
+                                                                .count();
+                                  for (const LogClockSource source : {LOG_CLOCK_TSC, LOG_CLOCK_COARSE}) {
+                                      LogClock clock(source);
+                                      if (source == LOG_CLOCK_TSC)
+                                          assert((clock.getSource() == LOG_CLOCK_TSC) == LogClock::hasInvariantTsc());
+                                      else
+                                          assert(clock.getSource() == LOG_CLOCK_COARSE);
+
+                                      // перевод в настенное время совпадает с часами ОС с точностью до тика COARSE
+                                      assert(std::abs(clock.toWallTime(clock.now()) - systemNow) < 50000000);
+
+                                      const uint64_t before = clock.now();
+                                      std::this_thread::sleep_for(std::chrono::milliseconds(20));
+                                      clock.calibrate(true);
+                                      const int64_t elapsed = clock.toNanoseconds(clock.now() - before);
+                                      assert(elapsed >= 15000000 && elapsed < 1000000000);
+                                  }
+
+                                  // время строки - момент события, а не записи пачки
+                                  const std::string filename = "test_log.txt";
+                                  std::remove(filename.c_str());
+                                  Logger logger(filename);
+
+                                  std::string expected;
+                                  LogRecord   record{"Clock message", LogEvent(), INFO};
+                                  while (true) {
+                                      const auto now = std::chrono::system_clock::now();
+                                      const auto fraction =
+                                          std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch())
+                                              .count() % 1000;
+                                      if (fraction < 100 || fraction > 900) continue;  // не у границы секунды
+
+                                      record.ticks                   = logger.getClock().now();
+                                      const std::time_t  captureTime = std::chrono::system_clock::to_time_t(now);
+                                      std::ostringstream stream;
+                                      stream << std::put_time(std::localtime(&captureTime), "%d-%m-%Y %H:%M:%S");
+                                      expected = "[" + stream.str() + "] [INFO] Clock message";
+                                      break;
+                                  }
+                                  std::this_thread::sleep_for(std::chrono::milliseconds(1200));
+                                  logger.logBatch(&record, 1);
+
+                                  std::ifstream logFile(filename);
+                                  std::string   line;
+                                  std::getline(logFile, line);
+                                  assert(line == expected);
+                              }},
+
+                             {"testTracing",
+                              []() {
+                                  const std::string filename = "test_log.txt";
+                                  std::remove(filename.c_str());
+                                  Logger logger(filename);
+                                  assert(logger.getTracer() == nullptr);
+                                  { TraceSpan span(logger.getTracer(), "Ignored"); }  // без трассировщика - ничего
+
+                                  Tracer* tracer = logger.enableTracing(8);
+                                  assert(tracer != nullptr && logger.getTracer() == tracer);
+                                  auto work = [tracer]() {
+                                      TraceSpan outer(tracer, "Outer");
+                                      TraceSpan inner(tracer, "Inner", "value", 7);
+                                  };
+                                  std::thread worker(work);
+                                  worker.join();
+                                  work();
+
+                                  std::ostringstream stream;
+                                  assert(tracer->exportChromeTrace(stream) == 4);
+                                  const std::string json = stream.str();
+                                  assert(json.find("\"name\":\"Outer\",\"ph\":\"X\"") != std::string::npos);
+                                  assert(json.find("\"args\":{\"value\":7}") != std::string::npos);
+
+                                  // у потоков разные tid, у вложенного отрезка - тот же
+                                  std::vector<std::string> threadIds;
+                                  for (size_t pos = 0; (pos = json.find("\"tid\":", pos)) != std::string::npos;) {
+                                      pos += 6;
+                                      threadIds.push_back(json.substr(pos, json.find_first_of(",}", pos) - pos));
+                                  }
+                                  assert(threadIds.size() == 4);
+                                  assert(threadIds[0] == threadIds[1] && threadIds[2] == threadIds[3]);
+                                  assert(threadIds[0] != threadIds[2]);
+
+                                  // кольцо потока хранит последние capacity отрезков
+                                  for (int i = 0; i != 20; ++i) TraceSpan span(tracer, "Ring", "i", i);
+                                  stream.str("");
+                                  assert(tracer->exportChromeTrace(stream) == 10);
+                                  assert(stream.str().find("{\"i\":11}") == std::string::npos);
+                                  assert(stream.str().find("{\"i\":12}") != std::string::npos);
+
+                                  tracer->setEnabled(false);
+                                  { TraceSpan span(tracer, "Paused"); }
+                                  logger.log("Traced message");
+                                  tracer->setEnabled(true);
+                                  logger.log("Traced message");
+                                  stream.str("");
+                                  tracer->exportChromeTrace(stream);
+                                  assert(stream.str().find("Paused") == std::string::npos);
+                                  assert(stream.str().find("\"name\":\"Logger::writeRecord\"") != std::string::npos);
+                              }},
+                             {"testSharedLog",
+                              []() {
+                                  const std::string name = "/logger_test_" + std::to_string(getpid());
+                                  const std::string filename = "test_log.txt", childFilename = "test_child_log.txt";
+                                  std::remove(filename.c_str());
+                                  std::remove(childFilename.c_str());
+                                  SharedLogCollector::remove(name);
+
+                                  Logger             logger(filename);
+                                  SharedLogCollector collector(name, logger);
+                                  const std::string  longText(600, 'x');  // три ячейки кольца
+
+                                  // второй сборщик не подключится, даже из этого же процесса
+                                  bool isRejected = false;
+                                  try {
+                                      SharedLogCollector second(name, logger);
+                                  } catch (const std::runtime_error&) {
+                                      isRejected = true;
+                                  }
+                                  assert(isRejected);
+
+                                  const pid_t child = fork();
+                                  if (child == 0) {
+                                      Logger producer(childFilename);
+                                      producer.attachSharedLog(name);
+                                      for (int i = 0; i < 3; ++i) producer.log("Child " + std::to_string(i));
+                                      producer.log(longText, ERROR);
+
+                                      // падение посреди записи из двух ячеек: продолжение уже опубликовано
+                                      const int fd     = shm_open(name.c_str(), O_RDWR, 0);
+                                      void*     memory = mmap(nullptr, sizeof(SharedLogSegment),
+                                                              PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+                                      auto*     segment = static_cast<SharedLogSegment*>(memory);
+                                      for (auto& ring : segment->rings) {
+                                          if (ring.owner.load() != getpid()) continue;
+                                          const uint64_t ticket = ring.tail.fetch_add(2);
+                                          SharedLogSlot& next   = ring.slots[(ticket + 1) % SHARED_LOG_RING_CAPACITY];
+                                          next.slotCount        = 0;
+                                          next.sequence.store(ticket + 2);
+                                      }
+                                      _exit(0);  // без деструкторов: кольцо остается за мертвым процессом
+                                  }
+                                  int status = 0;
+                                  waitpid(child, &status, 0);
+                                  assert(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+
+                                  Logger producer(childFilename);
+                                  producer.attachSharedLog(name);
+                                  assert(producer.getSharedLog() != nullptr && collector.getProducerCount() == 2);
+                                  producer.log("Parent message", WARNING);
+
+                                  assert(collector.drain(true) == 5);
+                                  assert(collector.getReclaimed() == 2 && collector.getProducerCount() == 1);
+
+                                  std::ifstream            file(filename);
+                                  std::vector<std::string> lines;
+                                  for (std::string line; std::getline(file, line);) lines.push_back(line.substr(22));
+                                  assert(lines.size() == 5);
+                                  assert(lines[0] == "[INFO] Child 0" && lines[2] == "[INFO] Child 2");
+                                  assert(lines[3] == "[ERROR] " + longText);
+                                  assert(lines[4] == "[WARNING] Parent message");
+
+                                  // кольцо заполнено - записи не теряются, а идут в свой файл
+                                  for (int i = 0; i < 1030; ++i) producer.log("Overflow " + std::to_string(i));
+                                  assert(collector.getOverflowed() == 6);
+                                  assert(collector.drain(true) == SHARED_LOG_RING_CAPACITY);
+
+                                  std::ifstream childFile(childFilename);
+                                  std::string   line;
+                                  size_t        localCount = 0;
+                                  while (std::getline(childFile, line)) {
+                                      assert(line.find("Overflow 10") != std::string::npos);
+                                      ++localCount;
+                                  }
+                                  assert(localCount == 6);
+                                  SharedLogCollector::remove(name);
+                              }},
+                             {"testThreadAffinity", []() {
+                                 // список процессоров в формате cpuset и обратно
+                                 const std::vector<int> cpus = parseCpuList("0-2,5,7-8");
+                                 assert((cpus == std::vector<int>{0, 1, 2, 5, 7, 8}));
+                                 assert(formatCpuList(cpus) == "0-2,5,7-8");
+                                 assert(formatCpuList(parseCpuList("3,1,1")) == "1,3");
+                                 for (const char* list : {"", "a", "3-1", "1,", "-1"}) {
+                                     bool isThrown = false;
+                                     try {
+                                         parseCpuList(list);
+                                     } catch (const std::invalid_argument&) {
+                                         isThrown = true;
+                                     }
+                                     assert(isThrown);
+                                 }
+
+                                 // привязка потока к первому разрешенному процессору и возврат прежней маски
+                                 const std::vector<int> allowed = getThreadCpus();
+                                 assert(!allowed.empty() && getNodeCount() >= 1);
+                                 std::thread([&allowed]() {
+                                     pinCurrentThread({allowed[0]});
+                                     assert((getThreadCpus() == std::vector<int>{allowed[0]}));
+                                     assert(getCpuNode(allowed[0]) >= 0 && getCurrentNode() < getNodeCount());
+                                 }).join();
+                                 assert(getThreadCpus() == allowed);
+
+                                 // процессоры узла относятся к нему же; у несуществующего узла их нет
+                                 for (int node = 0; node != getNodeCount(); ++node) {
+                                     for (int cpu : getNodeCpus(node)) assert(getCpuNode(cpu) == node);
+                                 }
+                                 assert(getNodeCpus(getNodeCount() + 1024).empty());
+                             }},
+                             {"testSharedLogBackend", []() {
+                                 // два Logger на один файл (пути записаны по-разному) - один бэкенд и один индекс
+                                 const std::string filename = "test_lib_log.txt";
+                                 std::remove(filename.c_str());
+                                 std::remove(getLogIndexFilename(filename).c_str());
+                                 {
+                                     Logger first(filename, INFO, FAST), second("./" + filename, INFO, SAFELY);
+                                     assert(first.getBackend() == second.getBackend());
+
+                                     std::vector<std::thread> threads;
+                                     for (Logger* logger : {&first, &second}) {
+                                         threads.emplace_back([logger]() {
+                                             for (int i = 0; i < 1000; ++i)
+                                                 logger->log("Shared backend line " + std::to_string(i));
+                                         });
+                                     }
+                                     for (auto& thread : threads) thread.join();
+
+                                     // удаленный файл - уже другой журнал: новый Logger получает новый бэкенд
+                                     std::remove("test_lib_log_other.txt");
+                                     Logger other("test_lib_log_other.txt");
+                                     std::remove("test_lib_log_other.txt");
+                                     Logger recreated("test_lib_log_other.txt");
+                                     assert(other.getBackend() != recreated.getBackend());
+                                 }
+
+                                 std::ifstream file(filename);
+                                 std::string   line;
+                                 size_t        count = 0;
+                                 while (std::getline(file, line)) {
+                                     assert(line.find("] [INFO] Shared backend line ") != std::string::npos);
+                                     ++count;
+                                 }
+                                 assert(count == 2000);
+
+                                 // индекс описывает весь журнал одной цепочкой блоков
+                                 LogReader reader(filename);
+                                 assert(reader.query(LogQuery()).size() == 2000);
+
+                                 Logger reopened(filename);
+                                 assert(reopened.getBackend()->getFilename() == filename);
+
+                                 // у файла уже есть свой бэкенд: переоткрытие на него отклоняется, журнал прежний
+                                 Logger other("test_lib_log_other.txt");
+                                 bool   isRejected = false;
+                                 try {
+                                     reopened.reopen("test_lib_log_other.txt");
+                                 } catch (const std::runtime_error&) {
+                                     isRejected = true;
+                                 }
+                                 assert(isRejected && reopened.getBackend()->getFilename() == filename);
+                                 assert(other.getBackend() != reopened.getBackend());
+                             }},
+                             {"testLogBackendRelease", []() {
+                                 // последний Logger уходит в другом потоке, пока по тому же пути открывается новый
+                                 // (иногда после ротации): без взаимоблокировки, а индекс - цепочка без перекрытий
+                                 const std::string filename = "test_lib_log.txt", rotated = "test_lib_log_rotated.txt";
+                                 for (const std::string& name : {filename, rotated}) {
+                                     std::remove(name.c_str());
+                                     std::remove(getLogIndexFilename(name).c_str());
+                                 }
+
+                                 for (int i = 0; i < 200; ++i) {
+                                     auto last = std::make_unique<Logger>(filename, INFO, FAST);
+                                     last->log("Released backend line " + std::to_string(i));
+                                     std::thread releaser([&last]() { last.reset(); });
+                                     if (i % 10 == 9) {
+                                         std::rename(filename.c_str(), rotated.c_str());
+                                         std::rename(getLogIndexFilename(filename).c_str(),
+                                                     getLogIndexFilename(rotated).c_str());
+                                     }
+                                     Logger next(filename, INFO, FAST);
+                                     next.log("Next backend line " + std::to_string(i));
+                                     releaser.join();
+                                 }
+
+                                 // после последней ротации в новом журнале одна строка, в ротированном - двадцать
+                                 for (const auto& [name, lines] : {std::pair(filename, 1), std::pair(rotated, 20)}) {
+                                     std::ifstream  index(getLogIndexFilename(name), std::ios::binary);
+                                     LogIndexHeader header{};
+                                     LogIndexEntry  entry{};
+                                     uint64_t       indexedEnd = 0;
+                                     assert(index.read(reinterpret_cast<char*>(&header), sizeof(header)));
+                                     while (index.read(reinterpret_cast<char*>(&entry), sizeof(entry))) {
+                                         assert(entry.offset == indexedEnd);
+                                         indexedEnd += entry.size;
+                                     }
+                                     assert(indexedEnd == std::filesystem::file_size(name));
+                                     assert(LogReader(name).query(LogQuery()).size() == static_cast<size_t>(lines));
+                                 }
+                             }},
+                             {"testInlineLevelCheck", []() {
+                                 // проверка уровня в заголовке: отфильтрованное не пишется, самописец получает всё
+                                 const std::string filename = "test_lib_log.txt";
+                                 std::remove(filename.c_str());
+                                 Logger        logger(filename, WARNING);
+                                 LogComponent& component = logger.getComponent("Inline");
+                                 assert(!logger.isEnabled(INFO) && logger.isEnabled(WARNING));
+                                 logger.enableFlightRecorder("test_crash_dump.log", 16);
+
+                                 logger.log("Filtered message", INFO);
+                                 logger.log("", ERROR);
+                                 logger.logEvent(LogEvent("Inline", "filtered {}.", {intField("value", 1)}), INFO);
+                                 component.log("Filtered component message", INFO);
+                                 logger.log("Accepted message", ERROR);
+                                 component.logEvent(LogEvent("Inline", "accepted {}.", {intField("value", 2)}),
+                                                    WARNING);
+                                 assert(logger.getFlightRecorder()->dumpToFile());
+
+                                 std::ifstream dumpFile("test_crash_dump.log");
+                                 std::string   content((std::istreambuf_iterator<char>(dumpFile)),
+                                                       std::istreambuf_iterator<char>());
+                                 assert(content.find("[INFO] Filtered message") != std::string::npos);
+                                 assert(content.find("[INFO] Inline | filtered 1.") != std::string::npos);
+                                 assert(content.find("[INFO] Filtered component message") != std::string::npos);
+                                 std::remove("test_crash_dump.log");
+
+                                 logger.changeLogLevel(INFO);
+                                 assert(component.isEnabled(INFO) && logger.getLogLevel() == INFO);
+                                 component.log("Accepted component message", INFO);
+
+                                 std::ifstream            file(filename);
+                                 std::vector<std::string> lines;
+                                 for (std::string line; std::getline(file, line);) lines.push_back(line.substr(22));
+                                 assert(lines.size() == 3);
+                                 assert(lines[0] == "[ERROR] Accepted message");
+                                 assert(lines[1] == "[WARNING] Inline | accepted 2.");
+                                 assert(lines[2] == "[INFO] Accepted component message");
+                             }},
                              {"testCreateLogFileInInaccessibleDirectory", []() {
                                   const std::string filenameToDelete = "test_log.txt",
                                                     filename         = "root/" + filenameToDelete;
@@ -477,14 +1175,14 @@ int main() {
              std::ifstream logFile(filename);
              std::string   line;
              while (std::getline(logFile, line)) {
-                 if (line.find("APP | START THREAD runMazeGenMulti") != std::string::npos) ++mazeGen;
-                 if (line.find("APP | END THREAD runMazeGenMulti") != std::string::npos) ++mazeGen;
+                 if (line.find("APP | START TASK generateMaze") != std::string::npos) ++mazeGen;
+                 if (line.find("APP | END TASK generateMaze") != std::string::npos) ++mazeGen;
 
-                 if (line.find("APP | START THREAD runGameMulti") != std::string::npos) ++game;
-                 if (line.find("APP | END THREAD runGameMulti") != std::string::npos) ++game;
+                 if (line.find("APP | START TASK playGame") != std::string::npos) ++game;
+                 if (line.find("APP | END TASK playGame") != std::string::npos) ++game;
 
-                 if (line.find("APP | START THREAD logMulti") != std::string::npos) ++log;
-                 if (line.find("APP | END THREAD logMulti") != std::string::npos) ++log;
+                 if (line.find("APP | START TASK writeLogs") != std::string::npos) ++log;
+                 if (line.find("APP | END TASK writeLogs") != std::string::npos) ++log;
              }
 
              assert(mazeGen == 2 && game == 2 && log == 2);
@@ -539,6 +1237,705 @@ int main() {
              std::remove(filename.c_str());
              assert(moveUP && !moveRIGHT);
          }},
+        {"testHeadlessSimulation",
+         []() {
+             // поиск в ширину по полю дает команды, которые гарантированно доводят до финиша
+             auto solve = [](const GameField& gameField) {
+                 std::vector<std::vector<char>> via(ROWS, std::vector<char>(COLUMNS, 0));
+                 std::queue<Position>           queue;
+                 queue.push(GAME_BEGIN);
+                 via[GAME_BEGIN.x][GAME_BEGIN.y] = '$';
+                 while (!queue.empty() && !(queue.front() == GAME_END)) {
+                     const Position current = queue.front();
+                     queue.pop();
+                     for (const auto& direction : MOVE_DIRECTIONS) {
+                         const Position next = {current.x + direction.offset.x, current.y + direction.offset.y};
+                         if (!gameField.canMove(next) || via[next.x][next.y] != 0) continue;
+                         via[next.x][next.y] = direction.key;
+                         queue.push(next);
+                     }
+                 }
+
+                 std::string moves;
+                 for (Position current = GAME_END; !(current == GAME_BEGIN);) {
+                     const MoveDirection* direction = findMoveDirection(via[current.x][current.y]);
+                     moves.insert(moves.begin(), direction->key);
+                     current = {current.x - direction->offset.x, current.y - direction->offset.y};
+                 }
+                 return moves;
+             };
+
+             SimulationEngine engine;
+             engine.generate(42);
+             SimulationResult result = engine.run("w\na\nw\na\nx\n");
+             assert(result.moveCount == 5 && result.failedMoves == 4 && result.invalidMoves == 1);
+             assert(result.position == GAME_BEGIN && !result.isFinished);
+             assert(engine.getEvents().size() == 1 + 5 * 2);
+             assert(engine.getEvents().back().logLevel == ERROR);
+
+             // одно зерно - один лабиринт, поэтому решение подходит и второму движку
+             const std::string moves = solve(engine.getGameField());
+             SimulationEngine  other;
+             other.generate(42);
+             engine.restart();
+             for (SimulationEngine* current : {&engine, &other}) {
+                 result = current->run(moves);
+                 assert(result.isFinished && result.position == GAME_END && result.failedMoves == 0);
+                 assert(result.moveCount == moves.size());
+             }
+
+             // много сессий подряд через журнал
+             const std::string filename = "test_lib_log.txt";
+             std::remove(filename.c_str());
+             {
+                 Logger           logger(filename, WARNING, FAST);
+                 SimulationEngine logged(&logger.getComponent("Player"), false);
+                 logged.generate(42);
+                 for (int i = 0; i != 10000; ++i) {
+                     logged.restart();
+                     assert(logged.run("wa" + moves).isFinished);
+                 }
+                 assert(logged.getEvents().empty());
+             }
+
+             LogReader reader(filename);
+             LogQuery  warnings;
+             warnings.from      = 1;
+             warnings.substring = "failed to move";
+             assert(reader.query(warnings).size() == 20000);
+         }},
+        {"testGameServerSessions",
+         []() {
+             const std::string filename = "test_lib_log.txt", socketPath = "test_game.sock";
+             std::remove(filename.c_str());
+
+             Logger      logger(filename, WARNING);
+             GameServer  server(socketPath, logger, 2);
+             std::thread serverThread([&server]() { server.run(); });
+
+             auto connectClient = [&socketPath]() {
+                 sockaddr_un address{};
+                 address.sun_family = AF_UNIX;
+                 std::strncpy(address.sun_path, socketPath.c_str(), sizeof(address.sun_path) - 1);
+                 const int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+                 assert(connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0);
+                 return fd;
+             };
+             auto request = [](int fd, const std::string& command) {
+                 const std::string line = command + '\n';
+                 assert(write(fd, line.data(), line.size()) == static_cast<ssize_t>(line.size()));
+                 std::string reply;
+                 char        symbol;
+                 while (read(fd, &symbol, 1) == 1 && symbol != '\n') reply += symbol;
+                 return reply;
+             };
+
+             // у каждого соединения свое поле: ходы одного клиента не видны другому
+             const int first = connectClient(), second = connectClient();
+             assert(request(first, "MOVE w") == "ERROR no game, send NEW <seed> first");
+             assert(request(first, "NEW 42").rfind("OK ", 0) == 0);
+             assert(request(first, "HINT").rfind("HINT d ", 0) == 0);
+             assert(request(second, "NEW 7").rfind("OK ", 0) == 0);
+             assert(request(first, "MOVE wa") == "AT 7 0 PLAYING");
+             assert(request(first, "MOVE d") == "AT 7 1 PLAYING");
+             assert(request(second, "MOVE a") == "AT 7 0 PLAYING");
+             assert(request(second, "JUMP") == "ERROR unknown command");
+             close(first);
+             close(second);
+
+             // клиенты, которые шлют команды и не читают ответы, не занимают потоки пула (их здесь два)
+             std::string commands;
+             for (int i = 0; i != 20000; ++i) commands += "MOVE wasd\n";
+             std::vector<int> greedy;
+             for (int i = 0; i != 2; ++i) {
+                 greedy.push_back(connectClient());
+                 assert(request(greedy.back(), "NEW 42").rfind("OK ", 0) == 0);
+                 fcntl(greedy.back(), F_SETFL, fcntl(greedy.back(), F_GETFL) | O_NONBLOCK);
+                 for (size_t sent = 0; sent < commands.size();) {
+                     const ssize_t size = write(greedy.back(), commands.data() + sent, commands.size() - sent);
+                     if (size <= 0) break;  // сервер перестал читать: буфер сокета полон
+                     sent += static_cast<size_t>(size);
+                 }
+             }
+             for (int i = 0; i != 4; ++i) {
+                 const int other = connectClient();
+                 assert(request(other, "NEW 7").rfind("OK ", 0) == 0);
+                 close(other);
+             }
+
+             // строка без перевода строки длиннее MAX_COMMAND_SIZE - клиент отключается
+             const int         endless = connectClient();
+             const std::string garbage(64 * 1024, 'x');
+             (void)!send(endless, garbage.data(), garbage.size(), MSG_NOSIGNAL);
+             char symbol;
+             assert(read(endless, &symbol, 1) <= 0);
+             close(endless);
+             for (const int fd : greedy) close(fd);
+
+             server.stop();
+             serverThread.join();
+             assert(server.getSessionCount() == 9);
+         }},
+        {"testPlayableWithoutDelay",
+         []() {
+             const std::string filename = "test_lib_log.txt";
+             std::remove(filename.c_str());
+
+             std::istringstream inputStream(std::to_string(Choice::PLAY) + "w\n");
+             std::cin.rdbuf(inputStream.rdbuf());
+
+             const auto begin = std::chrono::steady_clock::now();
+             app              = std::make_unique<MultithreadAppManager>(filename);
+             app->run();
+             const auto elapsed = std::chrono::steady_clock::now() - begin;
+
+             // раньше только ожидание готовности лабиринта занимало 2 секунды
+             assert(app->isMazeGenerated());
+             assert(app->getPlayableLatency().count() >= 0);
+             assert(elapsed < std::chrono::seconds(2));
+
+             bool          playable = false, endLog = false;
+             std::ifstream logFile(filename);
+             std::string   line;
+             while (std::getline(logFile, line)) {
+                 if (line.find("[INFO] APP | playable ") != std::string::npos) playable = true;
+                 if (line.find("APP | END TASK writeLogs") != std::string::npos) endLog = true;
+             }
+             assert(playable && endLog);
+         }},
+        {"testDistanceField",
+         []() {
+             // эталон - обычный поиск в ширину от финиша по текущему полю
+             auto checkDistances = [](const GameField& gameField) {
+                 std::vector<std::vector<int>> expected(ROWS, std::vector<int>(COLUMNS, UNREACHABLE_DISTANCE));
+                 std::queue<Position>          queue;
+                 expected[GAME_END.x][GAME_END.y] = 0;
+                 for (queue.push(GAME_END); !queue.empty(); queue.pop()) {
+                     const Position current = queue.front();
+                     for (const auto& direction : MOVE_DIRECTIONS) {
+                         const Position next = {current.x + direction.offset.x, current.y + direction.offset.y};
+                         if (!gameField.canMove(next) && !(next == GAME_BEGIN)) continue;
+                         if (expected[next.x][next.y] != UNREACHABLE_DISTANCE) continue;
+                         expected[next.x][next.y] = expected[current.x][current.y] + 1;
+                         queue.push(next);
+                     }
+                 }
+
+                 for (int x = 0; x != ROWS; ++x) {
+                     for (int y = 0; y != COLUMNS; ++y) assert(gameField.getDistance({x, y}) == expected[x][y]);
+                 }
+             };
+
+             GameField gameField(ROWS, COLUMNS);
+             gameField.generate(2024);
+             checkDistances(gameField);
+
+             // по подсказкам доходим до финиша ровно за оптимальное число ходов
+             Position position = GAME_BEGIN;
+             uint16_t moves    = 0;
+             for (const MoveDirection* hint; (hint = gameField.getHint(position)) != nullptr; ++moves)
+                 position = {position.x + hint->offset.x, position.y + hint->offset.y};
+             assert(position == GAME_END && moves == gameField.getDistance(GAME_BEGIN));
+
+             // точечные изменения лабиринта обновляют расстояния так же, как полный пересчет
+             std::mt19937 random(7);
+             for (int i = 0; i != 500; ++i) {
+                 const Position cell = {1 + static_cast<int>(random() % (ROWS - 2)),
+                                        1 + static_cast<int>(random() % (COLUMNS - 2))};
+                 gameField.setBlock(cell, random() % 3 != 0);
+                 checkDistances(gameField);
+             }
+         }},
+        {"testMazePack",
+         []() {
+             const std::string filename = "test_mazes.pack";
+             writeMazePack(filename, 20, 100);
+
+             GameField            loaded(ROWS, COLUMNS), generated(ROWS, COLUMNS);
+             std::vector<uint8_t> loadedCells(loaded.getPackedSize()), generatedCells(generated.getPackedSize());
+             {
+                 MazePack pack(filename);
+                 assert(pack.getCount() == 20);
+
+                 // из набора получается тот же лабиринт, что и генерацией по тому же зерну
+                 const MazeInfo info = pack.load(3, loaded);
+                 generated.generate(103);
+                 loaded.saveCells(loadedCells.data());
+                 generated.saveCells(generatedCells.data());
+                 assert(info.seed == 103 && loadedCells == generatedCells);
+                 assert(info.solutionLength == generated.getDistance(GAME_BEGIN));
+                 assert(loaded.getDistance(GAME_BEGIN) == info.solutionLength && loaded.getHint(GAME_BEGIN) != nullptr);
+
+                 // когда набор кончается, лабиринты приходят из фонового потока
+                 MazePool pool(&pack, 4, 18, 5000);
+                 for (uint32_t i = 0; i != 20; ++i) assert(pool.take(loaded).seed == 100 + (18 + i) % 20);
+                 for (uint32_t seed = 5000; seed != 5006; ++seed) {
+                     const MazeInfo next = pool.take(loaded);
+                     assert(next.seed == seed && next.solutionLength == loaded.getDistance(GAME_BEGIN));
+                 }
+             }
+
+             std::ofstream(filename) << "not a maze pack, but long enough to hold a header";
+             bool isRejected = false;
+             try {
+                 MazePack pack(filename);
+             } catch (const std::runtime_error&) {
+                 isRejected = true;
+             }
+             assert(isRejected);
+             std::remove(filename.c_str());
+         }},
+        {"testSessionReplay",
+         []() {
+             const std::string filename = "test_lib_log.txt", replayFilename = "test_replay_log.txt",
+                               recordFilename = "test_session.rec";
+             std::remove(filename.c_str());
+             std::remove(replayFilename.c_str());
+
+             std::istringstream inputStream(std::to_string(Choice::PLAY) + "\nw\nx\nd ERROR\n1\n1\ns WARNING\na\n");
+             std::cin.rdbuf(inputStream.rdbuf());
+
+             app = std::make_unique<MultithreadAppManager>(filename);
+             app->recordSession(recordFilename);
+             app->run();
+
+             const SessionRecording recording = loadSession(recordFilename);
+             assert(recording.moves.size() == 6);
+             assert(recording.moves[2].move == 'd' && recording.moves[2].moveLevel == ERROR);
+             assert(recording.moves[3].move == '1' && recording.moves[3].chosenLevel == WARNING);
+             for (size_t i = 1; i != recording.moves.size(); ++i)
+                 assert(recording.moves[i].time >= recording.moves[i - 1].time);
+
+             {
+                 Logger replayLogger(replayFilename);
+                 replaySession(recording, &replayLogger.getComponent("Player"));
+             }
+
+             // журнал повтора совпадает с журналом игры с точностью до времени записи
+             auto readPlayerLines = [](const std::string& logFilename) {
+                 std::vector<std::string> lines;
+                 std::ifstream            logFile(logFilename);
+                 std::string              line;
+                 while (std::getline(logFile, line)) {
+                     if (line.find("Player::processMove") == std::string::npos &&
+                         line.find("Player::processDLL") == std::string::npos &&
+                         line.find("Player::printAboutChangingDLL") == std::string::npos)
+                         continue;
+                     lines.push_back(line.substr(line.find("] ") + 2));
+                 }
+                 // ERROR и WARNING обгоняют INFO в очереди игры: порядок сохраняется только внутри уровня
+                 std::stable_sort(lines.begin(), lines.end(), [](const std::string& left, const std::string& right) {
+                     return left.substr(0, left.find(']')) < right.substr(0, right.find(']'));
+                 });
+                 return lines;
+             };
+             const std::vector<std::string> gameLines = readPlayerLines(filename);
+             assert(!gameLines.empty());
+             assert(gameLines == readPlayerLines(replayFilename));
+
+             // без журнала повтор идет со скоростью разбора: миллион ходов - доли секунды
+             SessionRecording bigRecording = recording;
+             bigRecording.moves.clear();
+             for (int i = 0; i != 1000000; ++i)
+                 bigRecording.moves.push_back({i, "wasd"[i % 4], SESSION_NO_LEVEL, SESSION_NO_LEVEL});
+
+             const auto             begin  = std::chrono::steady_clock::now();
+             const SimulationResult result = replaySession(bigRecording);
+             assert(std::chrono::steady_clock::now() - begin < std::chrono::seconds(2));
+             assert(result.moveCount == bigRecording.moves.size() || result.isFinished);
+             assert(result.invalidMoves == 0);
+
+             std::remove(recordFilename.c_str());
+             std::remove(replayFilename.c_str());
+         }},
+        {"testRawInputReader",
+         []() {
+             int inputPipe[2];
+             assert(pipe(inputPipe) == 0);
+
+             {
+                 InputReader input(inputPipe[0]);
+                 assert(!input.isRawMode());  // канал - не терминал
+
+                 // стрелки превращаются в wasd, переводы строк не нужны
+                 const std::string typed = "w\033[Bd\n\033[Dx";
+                 assert(write(inputPipe[1], typed.data(), typed.size()) == static_cast<ssize_t>(typed.size()));
+
+                 std::string keys;
+                 while (keys.size() < 5 && input.waitKeys(keys, 1000)) {}
+                 assert(keys == "wsdax");
+
+                 // зажатая клавиша: очередь ограничена, лишние нажатия не копятся
+                 const std::string held(200, 'd');
+                 assert(write(inputPipe[1], held.data(), held.size()) == static_cast<ssize_t>(held.size()));
+                 std::this_thread::sleep_for(std::chrono::milliseconds(100));
+                 keys.clear();
+                 assert(input.waitKeys(keys, 1000));
+                 assert(!keys.empty() && keys.size() <= INPUT_QUEUE_SIZE);
+
+                 // конец ввода
+                 close(inputPipe[1]);
+                 keys.clear();
+                 while (input.waitKeys(keys, 1000)) keys.clear();
+             }
+             close(inputPipe[0]);
+         }},
+        {"testSolverBots",
+         []() {
+             const std::string filename = "test_bots_log.txt";
+             std::remove(filename.c_str());
+
+             // A* всегда доходит по кратчайшему пути и ни разу не упирается в стену
+             BotReport astar;
+             {
+                 Logger logger(filename, INFO, FAST);
+                 astar = runBots(&logger.getComponent("Player"), "astar", 200, 4);
+             }
+             assert(astar.botCount == 200 && astar.finishedCount == 200 && astar.failedMoves == 0);
+
+             // на каждый ход две строки, как у Player::processMove: команда и результат
+             size_t        moveLines = 0, finishLines = 0;
+             std::ifstream logFile(filename);
+             std::string   line;
+             while (std::getline(logFile, line)) {
+                 if (line.find("Player::processMove") != std::string::npos) ++moveLines;
+                 if (line.find("Player::play | finished the game") != std::string::npos) ++finishLines;
+             }
+             assert(moveLines == astar.moveCount * 2 && finishLines == 200);
+
+             SimulationEngine engine(nullptr, false);
+             engine.generate(1);
+             const BotReport single = runBots(nullptr, "astar", 1, 1);
+             assert(single.moveCount == engine.getGameField().getDistance(GAME_BEGIN));
+
+             // остальные стратегии ограничены числом ходов
+             const BotReport random = runBots(nullptr, "random", 50, 4, 500);
+             assert(random.moveCount <= 50 * 500 && random.failedMoves > 0);
+             const BotReport wall = runBots(nullptr, "wall", 50, 4, 5000);
+             assert(wall.moveCount <= 50 * 5000 && wall.finishedCount > 0);
+
+             bool isThrown = false;
+             try {
+                 runBots(nullptr, "teleport", 1, 1);
+             } catch (const std::invalid_argument&) {
+                 isThrown = true;
+             }
+             assert(isThrown);
+             std::remove(filename.c_str());
+         }},
+        {"testMazeGenerationStable",
+         []() {
+             // наборы лабиринтов и записи игр хранят только зерно: лабиринт по зерну не должен меняться.
+             // отпечаток снят с прежнего генератора (по клетке за раз, с проверками границ)
+             uint64_t hash     = 1469598103934665603ull;
+             int      attempts = 0;
+             for (unsigned seed = 1; seed <= 200; ++seed) {
+                 GameField gameField(ROWS, COLUMNS);
+                 attempts += gameField.generate(seed);
+
+                 std::vector<uint8_t> cells(gameField.getPackedSize());
+                 gameField.saveCells(cells.data());
+                 for (const uint8_t byte : cells) hash = (hash ^ byte) * 1099511628211ull;
+                 hash = (hash ^ gameField.getDistance(GAME_BEGIN)) * 1099511628211ull;
+
+                 // упаковка и распаковка по 16 клеток дают то же поле
+                 GameField loaded(ROWS, COLUMNS);
+                 loaded.loadCells(cells.data(), seed);
+                 for (int x = 0; x != ROWS; ++x) {
+                     for (int y = 0; y != COLUMNS; ++y) assert(loaded.canMove({x, y}) == gameField.canMove({x, y}));
+                 }
+             }
+             assert(hash == 0xae2b90d901300c38ull && attempts == 1211);
+         }},
+        {"testDynamicMaze",
+         []() {
+             const int rows = 101, columns = 301;
+             GameField gameField(rows, columns);
+             gameField.generate(7);
+
+             const Position start = {rows / 2, 0}, finish = gameField.getFinish();
+             DynamicMaze    maze(gameField, 7);
+             assert(maze.isConnected(start, finish));
+
+             // эталон - разметка компонент обходом всего поля
+             std::mt19937 random(7);
+             auto         checkComponents = [&]() {
+                 std::vector<int> components(rows * columns, -1);
+                 std::queue<int>  queue;
+                 for (int cell = 0, count = 0; cell != rows * columns; ++cell) {
+                     if (components[cell] != -1 || !gameField.isPassable({cell / columns, cell % columns})) continue;
+                     components[cell] = count++;
+                     for (queue.push(cell); !queue.empty(); queue.pop()) {
+                         const Position current = {queue.front() / columns, queue.front() % columns};
+                         for (const auto& direction : MOVE_DIRECTIONS) {
+                             const Position next = {current.x + direction.offset.x, current.y + direction.offset.y};
+                             if (!gameField.isPassable(next) || components[next.x * columns + next.y] != -1) continue;
+                             components[next.x * columns + next.y] = components[cell];
+                             queue.push(next.x * columns + next.y);
+                         }
+                     }
+                 }
+
+                 for (int i = 0; i != 2000; ++i) {
+                     const int first = random() % (rows * columns), second = random() % (rows * columns);
+                     if (components[first] == -1 || components[second] == -1) continue;
+
+                     const bool isConnected =
+                         maze.isConnected({first / columns, first % columns}, {second / columns, second % columns});
+                     assert(isConnected == (components[first] == components[second]));
+                 }
+             };
+
+             // путь до финиша не пропадает ни на одном шаге, полный поиск при этом не нужен
+             const auto begin = std::chrono::steady_clock::now();
+             for (int i = 0; i != 50000; ++i) {
+                 maze.mutate(start);
+                 assert(gameField.getDistance(start) != UNREACHABLE_DISTANCE);
+                 if (i % 10000 == 0) checkComponents();
+             }
+             const auto elapsed = std::chrono::steady_clock::now() - begin;
+             checkComponents();
+
+             assert(maze.isConnected(start, finish));
+             assert(maze.getMutationCount() > 0 && maze.getRejectedCount() > 0);
+             std::cout << "dynamic maze: " << maze.getMutationCount() << " changes, " << maze.getRejectedCount()
+                       << " rejected, "
+                       << std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count() << " ms\n";
+
+             // блок на клетке игрока и на единственном проходе к финишу не ставится
+             assert(!maze.tryBlock({rows / 2, 1}, start));
+             assert(!maze.tryBlock({finish.x, finish.y - 1}, start));
+         }},
+        {"testLogRecordPool",
+         []() {
+             // после разгона записи только ходят между производителями и потоком журнала: ни одного malloc
+             LogRecordPool     pool;
+             const std::string longText(1000, 'x');  // цепочка из нескольких ячеек
+             auto              cycle = [&pool, &longText](int count, std::string& scratch) {
+                 for (int i = 0; i != count; ++i) {
+                     LogSlot* shortSlot = pool.acquire("Player::processMove | short message", LogEvent(), INFO);
+                     LogSlot* longSlot  = pool.acquire(longText, LogEvent(), ERROR);
+                     LogSlot* eventSlot = pool.acquire("", LogEvent("Pool::event", "{}", {intField("i", i)}), INFO);
+                     assert(shortSlot != nullptr && longSlot != nullptr && eventSlot != nullptr);
+                     assert(pool.getText(*shortSlot, scratch) == "Player::processMove | short message");
+                     assert(pool.getText(*longSlot, scratch) == longText);
+                     assert(eventSlot->event.fields[0].intValue == i);
+                     pool.release(shortSlot);
+                     pool.release(longSlot);
+                     pool.release(eventSlot);
+                 }
+             };
+
+             // несколько потоков гоняют ячейки через один свободный список
+             std::vector<std::thread> threads;
+             for (int i = 0; i != 4; ++i) {
+                 threads.emplace_back([&cycle]() {
+                     std::string scratch;
+                     cycle(20000, scratch);
+                 });
+             }
+             for (auto& thread : threads) thread.join();
+             assert(pool.getSlabCount() == 1);  // ячейки возвращаются, пул не растет
+
+             std::string scratch(longText.size(), ' ');
+             const size_t before = allocationCount.load();
+             cycle(100000, scratch);
+             assert(allocationCount.load() == before);
+
+             std::cout << "testLogRecordPool | slot size: " << sizeof(LogSlot) << " bytes\n";
+         }},
+        {"testLogLanes",
+         []() {
+             const std::string filename = "test_lib_log.txt";
+             std::remove(filename.c_str());
+
+             std::istringstream inputStream(std::to_string(Choice::PLAY) + "\n");
+             std::cin.rdbuf(inputStream.rdbuf());
+
+             app = std::make_unique<MultithreadAppManager>(filename);
+             app->configureLogLane(WARNING, 4, LANE_DROP_OLDEST);
+             app->configureLogLane(ERROR, 2, LANE_DROP_NEWEST);
+             bool isRejected = false;
+             try {
+                 app->configureLogLane(INFO, 0, LANE_BLOCK);
+             } catch (const std::invalid_argument&) {
+                 isRejected = true;
+             }
+             assert(isRejected);
+
+             // до run поток журнала не запущен: полосы переполняются и срабатывает политика.
+             // ходов нет, поэтому сама игра не пишет ни WARNING, ни ERROR
+             for (int i = 0; i != 10; ++i) app->writeLog("Lane warning " + std::to_string(i), WARNING);
+             for (int i = 0; i != 5; ++i) app->writeLog("Lane error " + std::to_string(i), ERROR);
+             app->run();
+
+             std::vector<std::string> lines;
+             std::ifstream            logFile(filename);
+             for (std::string line; std::getline(logFile, line);) lines.push_back(line);
+             auto find = [&lines](const std::string& text) {
+                 for (size_t i = 0; i != lines.size(); ++i) {
+                     if (lines[i].find(text) != std::string::npos) return static_cast<int>(i);
+                 }
+                 return -1;
+             };
+
+             for (int i = 0; i != 10; ++i) assert((find("Lane warning " + std::to_string(i)) >= 0) == (i >= 6));
+             for (int i = 0; i != 5; ++i) assert((find("Lane error " + std::to_string(i)) >= 0) == (i < 2));
+             assert(find("Lane error 1") < find("Lane warning 6") && find("Lane warning 9") < find("[INFO]"));
+             assert(find("APP | lane ERROR: 3 dropped") >= 0);
+
+             const LogLaneStats warnings = app->getLogLaneStats(WARNING), errors = app->getLogLaneStats(ERROR);
+             assert(warnings.dropped == 6 && warnings.written == 4);
+             assert(errors.dropped == 3 && errors.written == 2);
+             assert(errors.maxLatency.count() > 0 && errors.p99Latency <= errors.maxLatency);
+             assert(app->getLogLaneStats(INFO).written > 0);
+         }},
+        {"testLogLaneStop",
+         []() {
+             // производитель не из пула упирается в полосу на одну запись, а журнал тем временем
+             // останавливается: ни ждавшая запись, ни записи после остановки не пропадают
+             const std::string filename = "test_lib_log.txt";
+             std::remove(filename.c_str());
+
+             std::istringstream inputStream(std::to_string(Choice::PLAY) + "\n");
+             std::cin.rdbuf(inputStream.rdbuf());
+
+             app = std::make_unique<MultithreadAppManager>(filename);
+             app->configureLogLane(INFO, 1, LANE_BLOCK);
+             std::atomic<bool> isStopped(false);
+             std::thread       producer([&isStopped]() {
+                 for (int i = 0; i != 200; ++i) app->writeLog("Blocked record " + std::to_string(i));
+                 while (!isStopped.load()) std::this_thread::yield();
+                 for (int i = 200; i != 400; ++i) app->writeLog("Blocked record " + std::to_string(i));
+             });
+             app->run();
+             isStopped = true;
+             producer.join();
+
+             std::ifstream logFile(filename);
+             std::string   line;
+             size_t        count = 0;
+             while (std::getline(logFile, line)) count += line.find("Blocked record ") != std::string::npos;
+             assert(count == 400);
+         }},
+        {"testTaskScheduler",
+         []() {
+             // задачи ждут таймера, события и друг друга, не занимая поток: на одном рабочем потоке
+             // всё завершается, а заснувшие параллельно задачи спят одновременно, а не по очереди
+             for (const size_t workerCount : {size_t(1), size_t(3)}) {
+                 TaskScheduler     scheduler(workerCount);
+                 TaskEvent         event;
+                 std::atomic<int>  steps(0);
+                 std::atomic<bool> isWoken(false), isTimedOut(true);
+
+                 auto child = [&scheduler]() -> Task<int> {
+                     co_await scheduler.yield();
+                     co_return 42;
+                 };
+                 auto sleeper = [&scheduler, &steps]() -> Task<> {
+                     co_await scheduler.sleepFor(std::chrono::milliseconds(100));
+                     ++steps;
+                 };
+                 auto waiter = [&scheduler, &event, &isWoken, &isTimedOut, &child]() -> Task<> {
+                     isTimedOut = !co_await event.wait(scheduler, std::chrono::milliseconds(5));
+                     isWoken    = co_await event.wait(scheduler);
+                     assert(co_await child() == 42);
+                 };
+                 auto notifier = [&scheduler, &event]() -> Task<> {
+                     co_await scheduler.sleepFor(std::chrono::milliseconds(20));
+                     event.notify();
+                 };
+
+                 for (int i = 0; i != 5; ++i) scheduler.spawn(sleeper());
+                 scheduler.spawn(waiter());
+                 scheduler.spawn(notifier());
+
+                 const auto begin = std::chrono::steady_clock::now();
+                 scheduler.run();
+                 const auto elapsed = std::chrono::steady_clock::now() - begin;
+
+                 assert(steps == 5 && isTimedOut && isWoken);
+                 assert(elapsed >= std::chrono::milliseconds(100) && elapsed < std::chrono::milliseconds(400));
+                 assert(!TaskScheduler::isWorkerThread());
+             }
+
+             // исключение задачи выходит из run
+             TaskScheduler scheduler(2);
+             scheduler.spawn([]() -> Task<> {
+                 throw std::runtime_error("Error: task failed!");
+                 co_return;
+             }());
+             bool isThrown = false;
+             try {
+                 scheduler.run();
+             } catch (const std::runtime_error&) {
+                 isThrown = true;
+             }
+             assert(isThrown);
+
+             // задача без run удаляется вместе с планировщиком
+             auto token = std::make_shared<int>(0);
+             {
+                 TaskScheduler idle(1);
+                 idle.spawn([](std::shared_ptr<int> held) -> Task<> {
+                     (void)held;
+                     co_return;
+                 }(token));
+                 assert(token.use_count() == 2);
+             }
+             assert(token.use_count() == 1);
+         }},
+        {"testSingleWorkerGame",
+         []() {
+             // генерация, игра и журнал на одном рабочем потоке: задачи чередуются, игра проходит до конца
+             const std::string filename = "test_lib_log.txt";
+             std::remove(filename.c_str());
+
+             std::istringstream inputStream(std::to_string(Choice::PLAY) + "w\nx\nd\n");
+             std::cin.rdbuf(inputStream.rdbuf());
+
+             app = std::make_unique<MultithreadAppManager>(filename);
+             app->useWorkers(1);
+             assert(app->getScheduler().getWorkerCount() == 1);
+             app->run();
+             assert(app->isMazeGenerated());
+
+             size_t        moves = 0, incorrect = 0, endLog = 0;
+             std::ifstream logFile(filename);
+             std::string   line;
+             while (std::getline(logFile, line)) {
+                 if (line.find("Player::processMove | data = ") != std::string::npos) ++moves;
+                 if (line.find("Player::processMove | incorrect data") != std::string::npos) ++incorrect;
+                 if (line.find("APP | END TASK writeLogs") != std::string::npos) ++endLog;
+             }
+             assert(moves == 3 && incorrect == 1 && endLog == 1);
+         }},
+        {"testLogBenchmarkPinned",
+         []() {
+             // производители на рабочих потоках, привязанных к процессору: ни одна запись не теряется
+             const std::string filename = "test_lib_log.txt";
+             std::remove(filename.c_str());
+
+             MultithreadAppManager bench(filename, INFO, FAST);
+             bench.useWorkers(2);
+             bench.pinWorkers({getThreadCpus()[0]});
+             const LogBenchmarkReport report = bench.runLogBenchmark(3, 1000);
+             assert(report.records == 3000 && report.info.dropped == 0);
+
+             size_t        records = 0;
+             std::ifstream logFile(filename);
+             std::string   line;
+             while (std::getline(logFile, line)) records += line.find("APP | benchmark record") != std::string::npos;
+             assert(records == 3000);
+
+             bool isThrown = false;
+             try {
+                 bench.pinWorkers({CPU_SETSIZE});
+             } catch (const std::invalid_argument&) {
+                 isThrown = true;
+             }
+             assert(isThrown);
+         }},
     };
 
     runTests(onlyLibrary);
@@ -0,0 +1,145 @@
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+// нагрузочный клиент для сервера игр (app ... --server=<socket>):
+// каждое соединение играет подряд несколько сессий случайными ходами и замеряет время ответа на MOVE
+
+class GameClient {  // одно соединение с сервером
+   private:
+    int         fd_;      // сокет
+    std::string buffer_;  // прочитанное, но еще не разобранное
+
+   public:
+    explicit GameClient(const std::string& socketPath) : fd_(socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0)) {
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        std::strncpy(address.sun_path, socketPath.c_str(), sizeof(address.sun_path) - 1);
+
+        if (fd_ < 0 || connect(fd_, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+            if (fd_ >= 0) close(fd_);
+            throw std::runtime_error("Error: connecting to " + socketPath + "!");
+        }
+    }
+
+    ~GameClient() { close(fd_); }
+
+    std::string request(const std::string& command) {  // отправить команду и дождаться строки ответа
+        const std::string line = command + '\n';
+        for (size_t sent = 0; sent != line.size();) {
+            const ssize_t size = send(fd_, line.data() + sent, line.size() - sent, MSG_NOSIGNAL);
+            if (size <= 0) throw std::runtime_error("Error: sending to server!");
+            sent += static_cast<size_t>(size);
+        }
+
+        size_t end;
+        while ((end = buffer_.find('\n')) == std::string::npos) {
+            char          chunk[512];
+            const ssize_t size = read(fd_, chunk, sizeof(chunk));
+            if (size <= 0) throw std::runtime_error("Error: server closed connection!");
+            buffer_.append(chunk, static_cast<size_t>(size));
+        }
+
+        std::string reply = buffer_.substr(0, end);
+        buffer_.erase(0, end + 1);
+        return reply;
+    }
+};
+
+int64_t getPercentile(const std::vector<int64_t>& sorted, double percentile) {
+    if (sorted.empty()) return 0;
+    return sorted[std::min(sorted.size() - 1, static_cast<size_t>(percentile * static_cast<double>(sorted.size())))];
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0]
+                  << " <socket> [-c connections] [-s sessions_per_connection] [-m moves_per_session]\n";
+        return 1;
+    }
+
+    size_t connections = 8, sessions = 100, moves = 50;
+    try {
+        for (int i = 2; i + 1 < argc; i += 2) {
+            const std::string option = argv[i];
+            const size_t      value  = std::stoul(argv[i + 1]);
+            if (option == "-c")
+                connections = value;
+            else if (option == "-s")
+                sessions = value;
+            else if (option == "-m")
+                moves = value;
+            else
+                throw std::invalid_argument("Unknown option: " + option);
+        }
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+
+    // у каждого потока свои замеры, объединяем после завершения
+    std::vector<std::vector<int64_t>> latencies(connections);
+    std::vector<std::string>          errors(connections);
+    std::vector<std::thread>          clients;
+
+    const auto begin = std::chrono::steady_clock::now();
+    for (size_t c = 0; c != connections; ++c) {
+        clients.emplace_back([&, c]() {
+            try {
+                GameClient   client(argv[1]);
+                std::mt19937 random(static_cast<unsigned>(c));
+                const char   keys[] = "wasd";
+                latencies[c].reserve(sessions * moves);
+
+                for (size_t s = 0; s != sessions; ++s) {
+                    client.request("NEW " + std::to_string(random()));
+                    for (size_t m = 0; m != moves; ++m) {
+                        const std::string command = std::string("MOVE ") + keys[random() % 4];
+                        const auto        sent    = std::chrono::steady_clock::now();
+                        if (client.request(command).rfind("AT ", 0) != 0)
+                            throw std::runtime_error("Error: unexpected reply!");
+
+                        const auto received = std::chrono::steady_clock::now();
+                        latencies[c].push_back(
+                            std::chrono::duration_cast<std::chrono::nanoseconds>(received - sent).count());
+                    }
+                }
+            } catch (const std::exception& e) {
+                errors[c] = e.what();
+            }
+        });
+    }
+    for (auto& client : clients) client.join();
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - begin;
+
+    for (const auto& error : errors) {
+        if (!error.empty()) {
+            std::cerr << error << std::endl;
+            return 1;
+        }
+    }
+
+    std::vector<int64_t> all;
+    for (const auto& latency : latencies) all.insert(all.end(), latency.begin(), latency.end());
+    std::sort(all.begin(), all.end());
+
+    const double totalSessions = static_cast<double>(connections * sessions);
+    std::cout << "Sessions: " << connections * sessions << " in " << elapsed.count() << " s ("
+              << totalSessions / elapsed.count() << " sessions/sec)\n"
+              << "Moves: " << all.size() << " (" << static_cast<double>(all.size()) / elapsed.count() << " moves/sec)\n"
+              << "Move latency, us: p50 " << getPercentile(all, 0.50) / 1000.0 << ", p90 "
+              << getPercentile(all, 0.90) / 1000.0 << ", p99 " << getPercentile(all, 0.99) / 1000.0 << ", max "
+              << (all.empty() ? 0 : all.back()) / 1000.0 << "\n";
+
+    return 0;
+}
\ No newline at end of file
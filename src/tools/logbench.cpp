@@ -0,0 +1,66 @@
+#include <logger/logger.h>
+
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+// цена одного вызова журнала: отфильтрованного уровнем и записанного в файл.
+// собирается дважды (make bench): build/logbench - с build/bench/liblogger.so (-O2), вызовы через PLT,
+// build/logbench-static - с liblogger.a через LTO, где код библиотеки встраивается в место вызова
+
+template <typename Call>
+double measure(size_t count, Call call) {  // наносекунд на вызов
+    const auto begin = std::chrono::steady_clock::now();
+    for (size_t i = 0; i != count; ++i) call(i);
+    const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - begin;
+    return elapsed.count() / static_cast<double>(count);
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <log_file> [-n calls]\n";
+        return 1;
+    }
+
+    size_t count = 10000000;
+    for (int i = 2; i + 1 < argc; i += 2) {
+        const std::string option = argv[i];
+        if (option != "-n") {
+            std::cerr << "Unknown option: " << option << std::endl;
+            return 1;
+        }
+        count = std::stoul(argv[i + 1]);
+    }
+
+    try {
+        std::remove(argv[1]);
+        Logger            logger(argv[1], WARNING, FAST);
+        LogComponent&     component = logger.getComponent("Bench");
+        const std::string message   = "benchmark message";
+
+        // отфильтрованные: до файла не доходит ничего, остается только проверка уровня
+        const double filtered = measure(count, [&](size_t) { logger.log(message, INFO); });
+        const double filteredComponent = measure(count, [&](size_t) { component.log(message, INFO); });
+        const double filteredEvent     = measure(count, [&](size_t i) {
+            logger.logEvent(LogEvent("Bench", "record {}.", {intField("record", static_cast<int64_t>(i))}), INFO);
+        });
+
+        // принятые: строка собирается и пишется в буфер файла (FAST - без сброса на каждую запись)
+        const size_t acceptedCount = count / 10 + 1;
+        const double accepted      = measure(acceptedCount, [&](size_t) { logger.log(message, ERROR); });
+        const double acceptedEvent = measure(acceptedCount, [&](size_t i) {
+            logger.logEvent(LogEvent("Bench", "record {}.", {intField("record", static_cast<int64_t>(i))}), ERROR);
+        });
+
+        std::cout << "Filtered, ns/call: log " << filtered << ", component " << filteredComponent << ", event "
+                  << filteredEvent << "\n"
+                  << "Accepted, ns/call: log " << accepted << ", event " << acceptedEvent << "\n";
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
\ No newline at end of file
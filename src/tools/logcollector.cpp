@@ -0,0 +1,66 @@
+#include <logger/sharedlog.h>
+
+#include <chrono>
+#include <csignal>
+#include <iostream>
+#include <string>
+#include <thread>
+
+// сборщик общего журнала: создает объект разделяемой памяти, вычитывает кольца всех процессов
+// (app ... --shared-log=<name>) и пишет их записи в один файл по порядку времени
+
+volatile std::sig_atomic_t isStopped = 0;
+
+void stopHandler(int) { isStopped = 1; }
+
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        std::cerr << "Usage: " << argv[0] << " <shared_log_name> <log_file> [-j] [-u]\n"
+                  << "  -j  JSON lines instead of text\n"
+                  << "  -u  remove the shared log on exit\n";
+        return 1;
+    }
+
+    bool isJson = false, isRemoved = false;
+    for (int i = 3; i < argc; ++i) {
+        const std::string option = argv[i];
+        if (option == "-j") {
+            isJson = true;
+        } else if (option == "-u") {
+            isRemoved = true;
+        } else {
+            std::cerr << "Unknown option: " << option << std::endl;
+            return 1;
+        }
+    }
+
+    try {
+        Logger logger(argv[2], INFO, FAST, isJson ? JSON : TEXT);
+        size_t written = 0;
+        {
+            SharedLogCollector collector(argv[1], logger);
+            std::signal(SIGINT, stopHandler);
+            std::signal(SIGTERM, stopHandler);
+            std::cerr << "Collecting " << argv[1] << " into " << argv[2] << " (Ctrl+C to stop)\n";
+
+            // опрос: пустой проход стоит несколько десятков наносекунд на кольцо, а производители не делают
+            // системных вызовов, чтобы разбудить сборщик
+            while (isStopped == 0) {
+                const size_t count = collector.drain();
+                written += count;
+                if (count == 0) std::this_thread::sleep_for(std::chrono::milliseconds(2));
+            }
+            written += collector.drain(true);
+
+            std::cerr << "Collected: " << written << " records, overflowed " << collector.getOverflowed()
+                      << ", reclaimed " << collector.getReclaimed() << " slots, producers left "
+                      << collector.getProducerCount() << "\n";
+        }
+        if (isRemoved) SharedLogCollector::remove(argv[1]);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,66 @@
+#include <logger/reader.h>
+
+#include <iostream>
+#include <sstream>
+#include <string>
+
+uint32_t parseLevelMask(const std::string& levels) {
+    // список уровней через запятую: INFO,ERROR
+    uint32_t          mask = 0;
+    std::stringstream stream(levels);
+    std::string       level;
+    while (std::getline(stream, level, ',')) {
+        if (level == "INFO")
+            mask |= 1u << INFO;
+        else if (level == "WARNING")
+            mask |= 1u << WARNING;
+        else if (level == "ERROR")
+            mask |= 1u << ERROR;
+        else
+            throw std::invalid_argument("Invalid log level: " + level);
+    }
+
+    return mask;
+}
+
+std::time_t parseTimeArgument(const std::string& time) {
+    const std::time_t result = parseLogTime(time);
+    if (result == -1) throw std::invalid_argument("Invalid time (expected dd-mm-YYYY HH:MM:SS): " + time);
+    return result;
+}
+
+int main(int argc, char* argv[]) {
+    // опции идут парами: у последней опции без значения - та же подсказка, а не молча пропущенный фильтр
+    if (argc < 2 || argc % 2 != 0) {
+        std::cerr << "Usage: " << argv[0]
+                  << " <log_file> [-f \"dd-mm-YYYY HH:MM:SS\"] [-t \"dd-mm-YYYY HH:MM:SS\"] [-l INFO,WARNING,ERROR]"
+                     " [-s substring]\n";
+        return 1;
+    }
+
+    try {
+        LogQuery query;
+        for (int i = 2; i != argc; i += 2) {
+            const std::string option = argv[i], value = argv[i + 1];
+            if (option == "-f")
+                query.from = parseTimeArgument(value);
+            else if (option == "-t")
+                query.to = parseTimeArgument(value);
+            else if (option == "-l")
+                query.levelMask = parseLevelMask(value);
+            else if (option == "-s")
+                query.substring = value;
+            else
+                throw std::invalid_argument("Unknown option: " + option);
+        }
+
+        LogReader    reader(argv[1]);
+        const size_t matched = reader.query(query, [](std::string_view line) { std::cout << line << '\n'; });
+        std::cerr << "Matched: " << matched << " (blocks: " << reader.getBlockCount() << ")\n";
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
\ No newline at end of file